@@ -0,0 +1,305 @@
+/*
+ * pmargp benchmarks
+ *
+ * Times registration, lookup, parsing and teardown across option counts and
+ * argv lengths, and runs glibc getopt_long over the same argv as a baseline.
+ * Results are written to stdout as a single JSON document so that runs can
+ * be diffed and tracked for regressions:
+ *
+ *     make bench > bench.json
+ *
+ * Every measurement is the best of several repetitions, in nanoseconds.
+ * Memory figures come from a counting allocator handed to
+ * parser_start_with_allocator, so they cover everything the parser owns.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "pmargp.h"
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#define KEY_SIZE 24
+
+static const int option_counts[] = {10, 100, 1000, 10000};
+static const long argv_lengths[] = {10, 1000, 100000, 1000000};
+
+// getopt_long scans its option table linearly for every token, so very large
+// products would dominate the run without telling us anything new.
+#define GETOPT_WORK_LIMIT 2000000000.0
+
+/* ---------------------------------------------------------------- timing */
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int repetitions(double work) {
+    if (work >= 1e6) return 3;
+    if (work >= 1e4) return 10;
+    return 50;
+}
+
+/* ------------------------------------------------------ counting allocator */
+
+typedef struct {
+    size_t current;
+    size_t peak;
+    size_t allocations;
+} bench_memory_t;
+
+typedef union {
+    size_t size;
+    long double align;
+} bench_header_t;
+
+static void *counting_alloc(void *ctx, size_t size) {
+    bench_memory_t *memory = ctx;
+    bench_header_t *header = malloc(sizeof(bench_header_t) + size);
+    if (header == NULL) return NULL;
+    header->size = size;
+    memory->current += size;
+    memory->allocations++;
+    if (memory->current > memory->peak) memory->peak = memory->current;
+    return header + 1;
+}
+
+static void counting_free(void *ctx, void *ptr) {
+    bench_memory_t *memory = ctx;
+    if (ptr == NULL) return;
+    bench_header_t *header = (bench_header_t *)ptr - 1;
+    memory->current -= header->size;
+    free(header);
+}
+
+/* ---------------------------------------------------------------- output */
+
+static bool first_result = true;
+
+static void emit(const char *benchmark, int options, long tokens, double ns, double ops,
+                 const bench_memory_t *memory) {
+    printf("%s\n    {\"benchmark\": \"%s\", \"options\": %d, \"tokens\": %ld, \"ns\": %.0f, \"ns_per_op\": %.3f",
+           first_result ? "" : ",", benchmark, options, tokens, ns, ops > 0 ? ns / ops : 0.0);
+    if (memory) {
+        printf(", \"peak_bytes\": %zu, \"allocations\": %zu", memory->peak, memory->allocations);
+    }
+    printf("}");
+    first_result = false;
+}
+
+/* -------------------------------------------------------------- workloads */
+
+typedef struct {
+    int count;
+    char (*keys)[KEY_SIZE];
+    int *values;
+} bench_options_t;
+
+static bench_options_t make_options(int count) {
+    bench_options_t options;
+    options.count = count;
+    options.keys = malloc((size_t)count * KEY_SIZE);
+    options.values = calloc((size_t)count, sizeof(int));
+    if (!options.keys || !options.values) {
+        fprintf(stderr, "bench: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < count; i++) {
+        snprintf(options.keys[i], KEY_SIZE, "--option-%d", i);
+    }
+    return options;
+}
+
+static void free_options(bench_options_t *options) {
+    free(options->keys);
+    free(options->values);
+}
+
+static int register_options(struct pmargp_parser_t *parser, const bench_options_t *options) {
+    for (int i = 0; i < options->count; i++) {
+        int error = add_argument(parser, NULL, options->keys[i], PMARGP_INT, &options->values[i],
+                                 "Generated option", false);
+        if (error != PMARGP_SUCCESS) return error;
+    }
+    return PMARGP_SUCCESS;
+}
+
+// argv of `tokens` entries after argv[0]: "--option-k" "k" pairs cycling
+// through the registered options.
+static char **make_argv(const bench_options_t *options, long tokens) {
+    char **argv = malloc((size_t)(tokens + 1) * sizeof(char *));
+    char *storage = malloc((size_t)tokens * KEY_SIZE);
+    if (!argv || !storage) {
+        fprintf(stderr, "bench: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    argv[0] = "bench";
+    for (long i = 0; i < tokens; i++) {
+        char *token = storage + i * KEY_SIZE;
+        int option = (int)((i / 2) % options->count);
+        if (i % 2 == 0) {
+            memcpy(token, options->keys[option], KEY_SIZE);
+        } else {
+            snprintf(token, KEY_SIZE, "%d", option);
+        }
+        argv[i + 1] = token;
+    }
+    return argv;
+}
+
+static void free_argv(char **argv) {
+    free(argv[1]);
+    free(argv);
+}
+
+static void bench_registration(const bench_options_t *options) {
+    double best_add = 0, best_bulk = 0, best_free = 0;
+    bench_memory_t memory = {0, 0, 0};
+    int reps = repetitions(options->count);
+
+    pmargp_spec_t *specs = malloc((size_t)options->count * sizeof(pmargp_spec_t));
+    for (int i = 0; i < options->count; i++) {
+        pmargp_spec_t spec = {NULL, options->keys[i], PMARGP_INT, &options->values[i], "Generated option", 0};
+        specs[i] = spec;
+    }
+
+    for (int r = 0; r < reps; r++) {
+        bench_memory_t run = {0, 0, 0};
+        pmargp_allocator_t allocator = {counting_alloc, counting_free, &run};
+        struct pmargp_parser_t parser;
+        parser_start_with_allocator(&parser, &allocator);
+
+        double start = now_ns();
+        if (register_options(&parser, options) != PMARGP_SUCCESS) {
+            fprintf(stderr, "bench: add_argument failed\n");
+            exit(EXIT_FAILURE);
+        }
+        double added = now_ns();
+        free_parser(&parser);
+        double freed = now_ns();
+
+        parser_start_with_allocator(&parser, &allocator);
+        double bulk_start = now_ns();
+        if (pmargp_add_arguments(&parser, specs, (size_t)options->count) != PMARGP_SUCCESS) {
+            fprintf(stderr, "bench: pmargp_add_arguments failed\n");
+            exit(EXIT_FAILURE);
+        }
+        double bulk_end = now_ns();
+        free_parser(&parser);
+
+        if (r == 0 || added - start < best_add) best_add = added - start;
+        if (r == 0 || freed - added < best_free) best_free = freed - added;
+        if (r == 0 || bulk_end - bulk_start < best_bulk) best_bulk = bulk_end - bulk_start;
+        memory = run;
+    }
+    free(specs);
+
+    emit("add_argument", options->count, 0, best_add, options->count, &memory);
+    emit("pmargp_add_arguments", options->count, 0, best_bulk, options->count, NULL);
+    emit("free_parser", options->count, 0, best_free, 1, NULL);
+}
+
+static void bench_lookup(const bench_options_t *options) {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    register_options(&parser, options);
+
+    const long lookups = 1000000;
+    double best = 0;
+    long found = 0;
+    for (int r = 0; r < 3; r++) {
+        double start = now_ns();
+        for (long i = 0; i < lookups; i++) {
+            found += get_argument(&parser, options->keys[i % options->count]) != NULL;
+        }
+        double elapsed = now_ns() - start;
+        if (r == 0 || elapsed < best) best = elapsed;
+    }
+    free_parser(&parser);
+    if (found != 3 * lookups) {
+        fprintf(stderr, "bench: lookups missed\n");
+        exit(EXIT_FAILURE);
+    }
+    emit("get_argument", options->count, 0, best, (double)lookups, NULL);
+}
+
+static void bench_parse(const bench_options_t *options, long tokens) {
+    char **argv = make_argv(options, tokens);
+    int argc = (int)tokens + 1;
+    int reps = repetitions((double)tokens);
+    double best = 0;
+    bench_memory_t memory = {0, 0, 0};
+
+    for (int r = 0; r < reps; r++) {
+        bench_memory_t run = {0, 0, 0};
+        pmargp_allocator_t allocator = {counting_alloc, counting_free, &run};
+        struct pmargp_parser_t parser;
+        parser_start_with_allocator(&parser, &allocator);
+        register_options(&parser, options);
+
+        double start = now_ns();
+        int error = parses(&parser, argc, argv);
+        double elapsed = now_ns() - start;
+        free_parser(&parser);
+        if (error != PMARGP_SUCCESS) {
+            fprintf(stderr, "bench: parses failed with %d\n", error);
+            exit(EXIT_FAILURE);
+        }
+        if (r == 0 || elapsed < best) best = elapsed;
+        memory = run;
+    }
+    emit("parses", options->count, tokens, best, (double)tokens, &memory);
+
+    if ((double)options->count * (double)tokens <= GETOPT_WORK_LIMIT) {
+        struct option *longopts = calloc((size_t)options->count + 1, sizeof(struct option));
+        for (int i = 0; i < options->count; i++) {
+            longopts[i].name = options->keys[i] + 2;
+            longopts[i].has_arg = required_argument;
+            longopts[i].flag = NULL;
+            longopts[i].val = 0;
+        }
+
+        best = 0;
+        for (int r = 0; r < repetitions((double)tokens); r++) {
+            long sum = 0;
+            int index = 0;
+            opterr = 0;
+            optind = 0; // full reinitialisation in glibc
+            double start = now_ns();
+            while (getopt_long(argc, argv, "", longopts, &index) == 0) {
+                sum += strtol(optarg, NULL, 10);
+                options->values[index] = (int)sum;
+            }
+            double elapsed = now_ns() - start;
+            if (r == 0 || elapsed < best) best = elapsed;
+        }
+        free(longopts);
+        emit("getopt_long", options->count, tokens, best, (double)tokens, NULL);
+    }
+    free_argv(argv);
+}
+
+int main(void) {
+    printf("{\n  \"library\": \"pmargp\",\n  \"version\": \"%s\",\n  \"unit\": \"ns\",\n  \"results\": [", PMARGP_VERSION);
+
+    for (size_t i = 0; i < sizeof(option_counts) / sizeof(option_counts[0]); i++) {
+        bench_options_t options = make_options(option_counts[i]);
+        bench_registration(&options);
+        bench_lookup(&options);
+        for (size_t j = 0; j < sizeof(argv_lengths) / sizeof(argv_lengths[0]); j++) {
+            bench_parse(&options, argv_lengths[j]);
+        }
+        free_options(&options);
+        fflush(stdout);
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("\n  ],\n  \"max_rss_kb\": %ld\n}\n", usage.ru_maxrss);
+    return EXIT_SUCCESS;
+}
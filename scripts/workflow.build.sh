@@ -16,9 +16,25 @@ test() {
     make test CFLAGS="-Wall -Wextra -std=$standard -fPIC"
 }
 
+# Function to run tests with the instrumentation compiled in
+stats() {
+    local standard=$1
+    echo "Running tests with $standard standard and PMARGP_STATS..."
+    make clean
+    make test CFLAGS="-Wall -Wextra -std=$standard -fPIC -DPMARGP_STATS"
+}
+
+# Function to run the stress suite and the fuzz driver
+stress() {
+    local standard=$1
+    echo "Running stress and fuzz tests with $standard standard..."
+    make clean
+    make stress fuzz CFLAGS="-Wall -Wextra -std=$standard -fPIC" FUZZ_CFLAGS="-Wall -Wextra -std=$standard -g -O1 -fsanitize=address,undefined -fno-sanitize-recover=undefined"
+}
+
 # Check if a standard is provided
 if [ "$#" -lt 2 ]; then
-    echo "Usage: $0 {build|test} <c-standard>"
+    echo "Usage: $0 {build|test|stats|stress} <c-standard>"
     exit 1
 fi
 
@@ -33,8 +49,14 @@ case "$action" in
     test)
         test "$standard"
         ;;
+    stats)
+        stats "$standard"
+        ;;
+    stress)
+        stress "$standard"
+        ;;
     *)
-        echo "Usage: $0 {build|test} <c-standard>"
+        echo "Usage: $0 {build|test|stats|stress} <c-standard>"
         exit 1
         ;;
 esac
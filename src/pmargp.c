@@ -1,154 +1,740 @@
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE // mmap and madvise under -std=c99
+#endif
 #include "pmargp.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
 #include <limits.h>
-#include <regex.h>
-
-#if  !defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE < 200112L
-// Code for when POSIX 2001 is not available
-char* strdup(const char* s) {
-    if (!s) return NULL;
-    size_t len = strlen(s) + 1;
-    char* copy = malloc(len);
+#include <float.h>
+#include <math.h>
+
+/*
+ * Instrumentation
+ *
+ * Built with -DPMARGP_STATS, the hot paths count into a pmargp_stats_t and
+ * time their stages. Otherwise every STAT_ macro expands to nothing, so the
+ * default build carries no counters, clock reads or branches for them.
+ */
+#ifdef PMARGP_STATS
+#include <time.h>
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+#define STAT_ADD(stats, field, n) ((stats)->field += (n))
+#define STAT_BUMP(counter) ((counter) ? (void)(*(counter))++ : (void)0)
+#define STAT_COUNTER(stats, field) (&(stats)->field)
+#define STAT_CLOCK(start) uint64_t start = monotonic_ns()
+#define STAT_ELAPSED(stats, field, start) ((stats)->field += monotonic_ns() - (start))
+#else
+#define STAT_ADD(stats, field, n) ((void)(stats))
+#define STAT_BUMP(counter) ((void)(counter))
+#define STAT_COUNTER(stats, field) NULL
+#define STAT_CLOCK(start) ((void)0)
+#define STAT_ELAPSED(stats, field, start) ((void)(stats))
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PMARGP_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(PMARGP_NO_THREADS)
+#define PMARGP_HAVE_THREADS 1
+#include <pthread.h>
+#endif
+
+/*
+ * Arena
+ *
+ * Blocks are chained newest first and grow geometrically, so a parser with
+ * thousands of arguments needs a handful of allocations and free_parser only
+ * walks the chain.
+ */
+typedef union {
+    long double ld;
+    long long ll;
+    void *ptr;
+    void (*fn)(void);
+} pmargp_max_align_t;
+
+struct pmargp_arena_block_t {
+    struct pmargp_arena_block_t *next;
+    size_t size;              // usable bytes in data
+    size_t used;              // bytes handed out from data
+    pmargp_max_align_t data[];
+};
+
+#define PMARGP_ARENA_ALIGN sizeof(pmargp_max_align_t)
+#define PMARGP_ARENA_MIN_BLOCK 1024
+#define PMARGP_ARENA_MAX_GROWTH (1 << 20)
+
+static void *default_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    return malloc(size);
+}
+
+static void default_free(void *ctx, void *ptr) {
+    (void)ctx;
+    free(ptr);
+}
+
+static inline size_t arena_align(size_t size) {
+    return (size + PMARGP_ARENA_ALIGN - 1) & ~(PMARGP_ARENA_ALIGN - 1);
+}
+
+static void *arena_alloc(pmargp_arena_t *arena, size_t size) {
+    size = arena_align(size ? size : 1);
+    struct pmargp_arena_block_t *block = arena->head;
+    if (block == NULL || block->size - block->used < size) {
+        size_t block_size = block ? block->size : PMARGP_ARENA_MIN_BLOCK / 2;
+        block_size = block_size < PMARGP_ARENA_MAX_GROWTH ? block_size * 2 : block_size;
+        if (block_size < size) block_size = size;
+
+        block = arena->allocator.alloc(arena->allocator.ctx, sizeof(*block) + block_size);
+        if (block == NULL) return NULL;
+        block->next = arena->head;
+        block->size = block_size;
+        block->used = 0;
+        arena->head = block;
+    }
+    void *ptr = (char *)block->data + block->used;
+    block->used += size;
+    return ptr;
+}
+
+// Grow the most recent allocation in place when it is at the end of the
+// current block, otherwise move it. The old copy stays in the arena until
+// free_parser, which is fine as long as callers grow geometrically.
+static void *arena_grow(pmargp_arena_t *arena, void *ptr, size_t old_size, size_t new_size) {
+    struct pmargp_arena_block_t *block = arena->head;
+    size_t old_aligned = arena_align(old_size);
+    if (ptr && block && old_aligned <= block->used &&
+        (char *)ptr + old_aligned == (char *)block->data + block->used &&
+        block->used - old_aligned + new_size <= block->size) {
+        block->used = block->used - old_aligned + arena_align(new_size);
+        return ptr;
+    }
+    void *grown = arena_alloc(arena, new_size);
+    if (grown && ptr) memcpy(grown, ptr, old_size);
+    return grown;
+}
+
+typedef struct {
+    struct pmargp_arena_block_t *block;
+    size_t used;
+} arena_mark_t;
+
+static inline arena_mark_t arena_mark(const pmargp_arena_t *arena) {
+    arena_mark_t mark = {arena->head, arena->head ? arena->head->used : 0};
+    return mark;
+}
+
+// Drop everything allocated since `mark`.
+static void arena_rewind(pmargp_arena_t *arena, arena_mark_t mark) {
+    while (arena->head != mark.block) {
+        struct pmargp_arena_block_t *next = arena->head->next;
+        if (arena->allocator.free) arena->allocator.free(arena->allocator.ctx, arena->head);
+        arena->head = next;
+    }
+    if (arena->head) arena->head->used = mark.used;
+}
+
+static char *arena_strndup(pmargp_arena_t *arena, const char *s, size_t len) {
+    char *copy = arena_alloc(arena, len + 1);
     if (copy) {
         memcpy(copy, s, len);
+        copy[len] = '\0';
     }
     return copy;
 }
-#endif
 
-#define LARGE_KEY_REGEX "^--[A-Za-z0-9]+([_-]?[A-Za-z0-9]+)*$"
-#define SHORT_KEY_REGEX "^-[A-Za-z]$"
+static char *arena_strdup(pmargp_arena_t *arena, const char *s) {
+    return arena_strndup(arena, s, strlen(s));
+}
+
+// Append to a list of argument indices. Capacity doubles from 4, so n
+// appends copy O(n) in total.
+static int push_index(pmargp_arena_t *arena, int **items, int *count, int idx) {
+    int n = *count;
+    if (n == 0 || (n >= 4 && (n & (n - 1)) == 0)) {
+        size_t capacity = n ? (size_t)n * 2 : 4;
+        int *grown = arena_grow(arena, *items, (size_t)n * sizeof(int), capacity * sizeof(int));
+        if (!grown) return PMARGP_ERR_MEMORY_ALLOCATION;
+        *items = grown;
+    }
+    (*items)[(*count)++] = idx;
+    return PMARGP_SUCCESS;
+}
+
+static void arena_release(pmargp_arena_t *arena) {
+    struct pmargp_arena_block_t *block = arena->head;
+    while (block) {
+        struct pmargp_arena_block_t *next = block->next;
+        if (arena->allocator.free) arena->allocator.free(arena->allocator.ctx, block);
+        block = next;
+    }
+    arena->head = NULL;
+}
+
+/*
+ * Key grammar, checked by the DFA below without compiling a regex:
+ *   long key:  ^--[A-Za-z0-9]+([_-]?[A-Za-z0-9]+)*$
+ *   short key: ^-[A-Za-z]$
+ */
+enum {
+    KEY_CLASS_OTHER,
+    KEY_CLASS_ALPHA,
+    KEY_CLASS_DIGIT,
+    KEY_CLASS_DASH,
+    KEY_CLASS_UNDERSCORE,
+    KEY_CLASS_COUNT
+};
+
+enum {
+    KEY_STATE_REJECT,
+    KEY_STATE_LONG_START,   // expecting the first '-'
+    KEY_STATE_LONG_DASH,    // expecting the second '-'
+    KEY_STATE_LONG_FIRST,   // expecting the first alphanumeric
+    KEY_STATE_LONG_WORD,    // inside an alphanumeric run (accepting)
+    KEY_STATE_LONG_SEP,     // after '_' or '-', expecting an alphanumeric
+    KEY_STATE_SHORT_START,  // expecting '-'
+    KEY_STATE_SHORT_LETTER, // expecting a single letter
+    KEY_STATE_SHORT_END,    // after the letter (accepting)
+    KEY_STATE_COUNT
+};
+
+static const unsigned char key_class[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 0,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 0, 0, 0, 0, 0, 0,
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 4,
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+static const unsigned char key_transition[KEY_STATE_COUNT][KEY_CLASS_COUNT] = {
+    /*                          other  alpha                   digit                   dash                    underscore */
+    [KEY_STATE_REJECT]       = {0,     0,                      0,                      0,                      0},
+    [KEY_STATE_LONG_START]   = {0,     0,                      0,                      KEY_STATE_LONG_DASH,    0},
+    [KEY_STATE_LONG_DASH]    = {0,     0,                      0,                      KEY_STATE_LONG_FIRST,   0},
+    [KEY_STATE_LONG_FIRST]   = {0,     KEY_STATE_LONG_WORD,    KEY_STATE_LONG_WORD,    0,                      0},
+    [KEY_STATE_LONG_WORD]    = {0,     KEY_STATE_LONG_WORD,    KEY_STATE_LONG_WORD,    KEY_STATE_LONG_SEP,     KEY_STATE_LONG_SEP},
+    [KEY_STATE_LONG_SEP]     = {0,     KEY_STATE_LONG_WORD,    KEY_STATE_LONG_WORD,    0,                      0},
+    [KEY_STATE_SHORT_START]  = {0,     0,                      0,                      KEY_STATE_SHORT_LETTER, 0},
+    [KEY_STATE_SHORT_LETTER] = {0,     KEY_STATE_SHORT_END,    0,                      0,                      0},
+    [KEY_STATE_SHORT_END]    = {0,     0,                      0,                      0,                      0},
+};
+
+static bool key_matches(const char *key, unsigned char state, unsigned char accept) {
+    for (const unsigned char *c = (const unsigned char *)key; *c && state != KEY_STATE_REJECT; c++) {
+        state = key_transition[state][key_class[*c]];
+    }
+    return state == accept;
+}
+
+static inline bool is_valid_long_key(const char *key) {
+    return key_matches(key, KEY_STATE_LONG_START, KEY_STATE_LONG_WORD);
+}
+
+static inline bool is_valid_short_key(const char *key) {
+    return key_matches(key, KEY_STATE_SHORT_START, KEY_STATE_SHORT_END);
+}
+
+static inline bool is_help_token(const char *token, size_t len) {
+    return (len == 6 && memcmp(token, "--help", 6) == 0) || (len == 2 && memcmp(token, "-h", 2) == 0);
+}
 
 static inline bool is_help(const char *flag) {
-    if (flag == NULL) return false;
-    return strcmp(flag, "--help") == 0 || strcmp(flag, "-h") == 0;
+    return flag != NULL && is_help_token(flag, strlen(flag));
 }
 
-#define PMARGS_IS_VALID_KEY(parser, key) (\
-            (parser->args[i].key && strcmp(parser->args[i].key, key) == 0) || \
-            (parser->args[i].short_key && strcmp(parser->args[i].short_key, key) == 0)\
-)
+#define PMARGP_INDEX_MIN_CAPACITY 16
 
-// NOTE: this runs O(n) we could probably achieve better results with 
-// hash-map with little to no collision allowing for O(1) best case.
-// but do we really need to add far more memeory into something simple
-pmargp_argument_t *get_argument(struct pmargp_parser_t* parser, const char *key) {
-    if (!parser || !key) {
-        return NULL;
+// FNV-1a, keys are short and this keeps the probe sequences well spread
+// even for generated keys that only differ in their last few bytes.
+static inline uint32_t key_hash(const char *key, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)key[i];
+        hash *= 16777619u;
     }
+    return hash;
+}
 
-    for (int i = 0; i < parser->argc; i++) {
-        if (PMARGS_IS_VALID_KEY(parser, key)) {
-            return &parser->args[i];
+// Maps "-a".."-z" to 0..25 and "-A".."-Z" to 26..51, anything else to -1.
+static inline int letter_slot(char c) {
+    if (c >= 'a' && c <= 'z') return c - 'a';
+    if (c >= 'A' && c <= 'Z') return 26 + (c - 'A');
+    return -1;
+}
+
+static inline int short_slot(const char *key, size_t len) {
+    if (len != 2 || key[0] != '-') return -1;
+    return letter_slot(key[1]);
+}
+
+// compares, when not NULL, counts the key comparisons made (PMARGP_STATS).
+static int index_find_long(const struct pmargp_parser_t *parser, const char *key, size_t len, uint64_t *compares) {
+    const pmargp_index_t *index = &parser->index;
+    if (index->capacity == 0) return -1;
+
+    uint32_t hash = key_hash(key, len);
+    size_t mask = index->capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const pmargp_slot_t *slot = &index->slots[i];
+        if (slot->index == 0) return -1;
+        if (slot->hash == hash) {
+            const char *candidate = parser->args[slot->index - 1].key;
+            STAT_BUMP(compares);
+            if (strncmp(candidate, key, len) == 0 && candidate[len] == '\0') {
+                return slot->index - 1;
+            }
         }
     }
-    return NULL;
 }
 
+static void index_place(pmargp_index_t *index, uint32_t hash, int idx) {
+    size_t mask = index->capacity - 1;
+    size_t i = hash & mask;
+    while (index->slots[i].index != 0) i = (i + 1) & mask;
+    index->slots[i].hash = hash;
+    index->slots[i].index = idx + 1;
+    index->count++;
+}
 
-int get_argument_index(struct pmargp_parser_t* parser, const char *key) {
-    if (!parser || !key) {
-        return -1;
-    }
+// Make room for `additional` long keys while keeping the load factor <= 1/2,
+// so that inserting them afterwards cannot fail.
+static int index_reserve(struct pmargp_parser_t *parser, size_t additional) {
+    pmargp_index_t *index = &parser->index;
+    size_t needed = (index->count + additional) * 2;
+    if (needed <= index->capacity) return PMARGP_SUCCESS;
 
-    for (int i = 0; i < parser->argc; i++) {
-        if (PMARGS_IS_VALID_KEY(parser, key)) {
-            return i;
+    size_t capacity = index->capacity ? index->capacity : PMARGP_INDEX_MIN_CAPACITY;
+    while (capacity < needed) capacity *= 2;
+
+    pmargp_slot_t *slots = arena_alloc(&parser->arena, capacity * sizeof(pmargp_slot_t));
+    if (slots == NULL) return PMARGP_ERR_MEMORY_ALLOCATION;
+    memset(slots, 0, capacity * sizeof(pmargp_slot_t));
+
+    pmargp_index_t grown = *index;
+    grown.slots = slots;
+    grown.capacity = capacity;
+    grown.count = 0;
+    for (size_t i = 0; i < index->capacity; i++) {
+        if (index->slots[i].index != 0) {
+            index_place(&grown, index->slots[i].hash, index->slots[i].index - 1);
         }
     }
-    return -1;
+    *index = grown;
+    return PMARGP_SUCCESS;
 }
 
-int check_regex(const char *pattern, const char *str) {
-    regex_t regex;
-    int ret;
+pmargp_argument_t *get_argument(struct pmargp_parser_t* parser, const char *key) {
+    int idx = get_argument_index(parser, key);
+    return idx < 0 ? NULL : &parser->args[idx];
+}
 
-    ret = regcomp(&regex, pattern, REG_EXTENDED);
-    if (ret) return 0; 
 
-    ret = regexec(&regex, str, 0, NULL, 0);
-    regfree(&regex); 
+static int find_argument(const struct pmargp_parser_t *parser, const char *key, size_t len) {
+    if (len < 2 || key[0] != '-') return -1;
+    if (key[1] == '-') return index_find_long(parser, key, len, NULL);
+    int slot = short_slot(key, len);
+    return slot < 0 ? -1 : parser->index.shorts[slot] - 1;
+}
 
-    return ret == 0;
+/*
+ * Abbreviations
+ *
+ * The long keys are copied, with their indices, into an array sorted by
+ * strcmp. Every key starting with a given prefix then sits in one contiguous
+ * run, found with two binary searches that only touch the array and the key
+ * bytes. The array is rebuilt when argc no longer matches the one it was
+ * built for, which only registration changes.
+ */
+static int compare_prefix(const void *a, const void *b) {
+    return strcmp(((const pmargp_prefix_t *)a)->key, ((const pmargp_prefix_t *)b)->key);
 }
 
-int add_argument(struct pmargp_parser_t* parser, const char* restrict short_key, const char* restrict key, 
-                 pmargp_type_t type, void* value_ptr, char *description, bool required) {
-    
-    if (parser == NULL) return PMARGP_ERR_NULL;
+static int prefix_index_build(struct pmargp_parser_t *parser) {
+    pmargp_index_t *index = &parser->index;
+    if (index->sorted_argc == parser->argc) return PMARGP_SUCCESS;
 
-    // Create a copy of the key and adjust it
-    char *adjusted_key = NULL;
-    if(key != NULL){
-        adjusted_key = strdup(key);
-        if (adjusted_key == NULL) return PMARGP_ERR_MEMORY_ALLOCATION;
+    pmargp_prefix_t *sorted = index->sorted;
+    if (index->count > index->sorted_count) {
+        sorted = arena_grow(&parser->arena, index->sorted, index->sorted_count * sizeof(pmargp_prefix_t),
+                            index->count * sizeof(pmargp_prefix_t));
+        if (!sorted) return PMARGP_ERR_MEMORY_ALLOCATION;
+    }
+    size_t count = 0;
+    for (int i = 0; i < parser->argc; i++) {
+        if (!parser->args[i].key) continue;
+        sorted[count].key = parser->args[i].key;
+        sorted[count].index = i;
+        count++;
+    }
+    if (count > 1) qsort(sorted, count, sizeof(pmargp_prefix_t), compare_prefix);
+    index->sorted = sorted;
+    index->sorted_count = count;
+    index->sorted_argc = parser->argc;
+    return PMARGP_SUCCESS;
+}
 
-        // Validate the large key using regex
-        if (!check_regex(LARGE_KEY_REGEX, adjusted_key)) {
-            free(adjusted_key);
-            return PMARGP_ERR_INVALID_KEY;  // Large key does not match regex
-        }
-        
+// Run [*first, *first + return) of sorted keys starting with key[0..len).
+static size_t prefix_range(const pmargp_index_t *index, const char *key, size_t len, size_t *first,
+                           uint64_t *compares) {
+    size_t lo = 0, hi = index->sorted_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        STAT_BUMP(compares);
+        if (strncmp(index->sorted[mid].key, key, len) < 0) lo = mid + 1; else hi = mid;
     }
+    *first = lo;
+    hi = index->sorted_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        STAT_BUMP(compares);
+        if (strncmp(index->sorted[mid].key, key, len) == 0) lo = mid + 1; else hi = mid;
+    }
+    return lo - *first;
+}
 
-    char *adjusted_short_key = NULL;
-    if (short_key != NULL) {
-        adjusted_short_key = strdup(short_key);
-        if (adjusted_short_key == NULL) {
-            free(adjusted_key);
-            return PMARGP_ERR_MEMORY_ALLOCATION;
-        }
+int get_argument_index(struct pmargp_parser_t* parser, const char *key) {
+    if (!parser || !key) {
+        return -1;
+    }
+    return find_argument(parser, key, strlen(key));
+}
+
+static int args_reserve(struct pmargp_parser_t *parser, size_t additional) {
+    size_t needed = (size_t)parser->argc + additional;
+    if (needed <= parser->capacity) return PMARGP_SUCCESS;
+
+    size_t capacity = parser->capacity ? parser->capacity * 2 : 8;
+    if (capacity < needed) capacity = needed;
+    pmargp_argument_t *new_args = arena_grow(&parser->arena, parser->args,
+                                             parser->capacity * sizeof(pmargp_argument_t),
+                                             capacity * sizeof(pmargp_argument_t));
+    if (new_args == NULL) return PMARGP_ERR_MEMORY_ALLOCATION;
+    parser->args = new_args;
+    parser->capacity = capacity;
+    return PMARGP_SUCCESS;
+}
 
-        // Validate the short key using regex
-        if (!check_regex(SHORT_KEY_REGEX, adjusted_short_key)) {
-            free(adjusted_key);
-            free(adjusted_short_key);
-            return PMARGP_ERR_INVALID_KEY;  // Short key does not match regex
+// Remove every index entry pointing at or past args[first], used to roll back
+// a partially indexed batch. Entries added after the existing ones never sit
+// inside an older probe sequence, so clearing them restores the table exactly.
+static void index_truncate(pmargp_index_t *index, int first) {
+    for (size_t i = 0; i < index->capacity; i++) {
+        if (index->slots[i].index > first) {
+            index->slots[i].index = 0;
+            index->count--;
         }
     }
+    for (int i = 0; i < 52; i++) {
+        if (index->shorts[i] > first) index->shorts[i] = 0;
+    }
+}
 
-    if (adjusted_key == NULL && adjusted_short_key == NULL){
+static int check_spec(const pmargp_spec_t *spec) {
+    // Validate the keys against the key grammar before copying anything
+    if (spec->key != NULL && !is_valid_long_key(spec->key)) {
+        return PMARGP_ERR_INVALID_KEY;  // Large key does not match the grammar
+    }
+    if (spec->short_key != NULL && !is_valid_short_key(spec->short_key)) {
+        return PMARGP_ERR_INVALID_KEY;  // Short key does not match the grammar
+    }
+    if (spec->key == NULL && spec->short_key == NULL) {
         return PMARGP_ERR_INVALID_KEY;
     }
+    if (is_help(spec->key)) {
+        return PMARGP_ERR_EXISTING_ARGUMENT;
+    }
+    if (spec->type < PMARGP_FLOAT || spec->type > PMARGP_CHOICE) {
+        return PMARGP_ERR_UNKNOWN_TYPE;
+    }
+    return PMARGP_SUCCESS;
+}
 
-    if (is_help(adjusted_key) || 
-        get_argument_index(parser, adjusted_key) >= 0 || 
-        (adjusted_short_key && get_argument_index(parser, adjusted_short_key) >= 0)) {
-        free(adjusted_key);
-        if (adjusted_short_key) free(adjusted_short_key);
-        return PMARGP_ERR_EXISTING_ARGUMENT;  // Either key or short key already exists
+static int add_arguments(struct pmargp_parser_t *parser, const pmargp_spec_t *specs, size_t n) {
+    if (parser->frozen) return PMARGP_ERR_FROZEN;
+    if (n > (size_t)(INT_MAX - parser->argc)) return PMARGP_ERR_MEMORY_ALLOCATION;
+
+    size_t long_keys = 0;
+    for (size_t i = 0; i < n; i++) {
+        int error = check_spec(&specs[i]);
+        if (error != PMARGP_SUCCESS) return error;
+        if (specs[i].key) long_keys++;
     }
 
-    pmargp_argument_t *new_args = realloc(parser->args, (parser->argc + 1) * sizeof(pmargp_argument_t));
-    if (new_args == NULL) {
-        free(adjusted_key);
-        if (adjusted_short_key) free(adjusted_short_key);
+    // Size the args array and the index once for the whole batch. Growing
+    // them does not change what is registered, so this is safe to keep on
+    // failure.
+    if (args_reserve(parser, n) != PMARGP_SUCCESS || index_reserve(parser, long_keys) != PMARGP_SUCCESS) {
         return PMARGP_ERR_MEMORY_ALLOCATION;
     }
-    parser->args = new_args;
 
-    pmargp_argument_t *arg = &parser->args[parser->argc];
-    arg->key = adjusted_key;  
-    arg->short_key = adjusted_short_key;
-    arg->description = description ? strdup(description) : NULL;
-    arg->type = type;
-    arg->required = required;
-    arg->value_ptr = value_ptr;
-    arg->allocated = false;
+    // Stage the batch past argc, indexing it as we go so that duplicates are
+    // caught both against existing arguments and within the batch.
+    int first = parser->argc;
+    int error = PMARGP_SUCCESS;
+    for (size_t i = 0; i < n; i++) {
+        const pmargp_spec_t *spec = &specs[i];
+        int idx = first + (int)i;
+        pmargp_argument_t *arg = &parser->args[idx];
+        arg->key = (char *)spec->key;
+        arg->short_key = (char *)spec->short_key;
+        arg->description = (char *)spec->description;
+        arg->type = spec->type;
+        arg->required = (spec->flags & PMARGP_FLAG_REQUIRED) != 0;
+        arg->value_ptr = spec->value_ptr;
+        arg->allocated = false;
+        arg->lazy = (spec->flags & PMARGP_FLAG_LAZY) != 0;
+        arg->owned = false;
+        arg->path = NULL;
+        arg->env = NULL;
+        arg->name = NULL;
+        arg->source = PMARGP_SOURCE_NONE;
+        arg->choices = NULL;
 
-    parser->argc++;
+        if (get_argument_index(parser, spec->key) >= 0 ||
+            get_argument_index(parser, spec->short_key) >= 0) {
+            error = PMARGP_ERR_EXISTING_ARGUMENT;  // Either key or short key already exists
+            break;
+        }
+        if (spec->key) {
+            index_place(&parser->index, key_hash(spec->key, strlen(spec->key)), idx);
+        }
+        if (spec->short_key) {
+            parser->index.shorts[short_slot(spec->short_key, 2)] = idx + 1;
+        }
+    }
+
+    // Copy the keys and descriptions into the arena, unless the caller lends
+    // them to us. Borrowed strings never enter the arena, so free_parser has
+    // nothing to release for them either.
+    arena_mark_t mark = arena_mark(&parser->arena);
+    for (size_t i = 0; i < n && error == PMARGP_SUCCESS; i++) {
+        if ((specs[i].flags | parser->flags) & PMARGP_FLAG_BORROWED) continue;
+        pmargp_argument_t *arg = &parser->args[first + (int)i];
+        if ((arg->key && !(arg->key = arena_strdup(&parser->arena, arg->key))) ||
+            (arg->short_key && !(arg->short_key = arena_strdup(&parser->arena, arg->short_key))) ||
+            (arg->description && !(arg->description = arena_strdup(&parser->arena, arg->description)))) {
+            error = PMARGP_ERR_MEMORY_ALLOCATION;
+        }
+    }
+
+    // Required arguments are listed so that check_required skips the rest
+    int *required_args = parser->required_args, required_count = parser->required_count;
+    for (size_t i = 0; i < n && error == PMARGP_SUCCESS; i++) {
+        if (!parser->args[first + (int)i].required) continue;
+        error = push_index(&parser->arena, &parser->required_args, &parser->required_count, first + (int)i);
+    }
+
+    if (error != PMARGP_SUCCESS) {
+        index_truncate(&parser->index, first);
+        arena_rewind(&parser->arena, mark);
+        parser->required_args = required_args;
+        parser->required_count = required_count;
+        return error;
+    }
 
+    for (size_t i = 0; i < n; i++) {
+        const pmargp_argument_t *arg = &parser->args[first + (int)i];
+        int key_width = arg->key ? (int)strlen(arg->key) : 0;
+        int short_width = arg->short_key ? (int)strlen(arg->short_key) : 0;
+        if (key_width > parser->help_key_width) parser->help_key_width = key_width;
+        if (short_width > parser->help_short_width) parser->help_short_width = short_width;
+    }
+    parser->argc += (int)n;
     return PMARGP_SUCCESS;
 }
 
-static bool help_info(int argc, char* argv[]) {
-    for (int i = 1; i < argc; i++) {
-        if (is_help(argv[i])) return true;
+int pmargp_add_arguments(struct pmargp_parser_t *parser, const pmargp_spec_t *specs, size_t n) {
+    if (parser == NULL || (specs == NULL && n > 0)) return PMARGP_ERR_NULL;
+    STAT_CLOCK(start);
+    int error = add_arguments(parser, specs, n);
+    STAT_ELAPSED(&parser->stats, registration_ns, start);
+    return error;
+}
+
+int add_argument(struct pmargp_parser_t* parser, const char* restrict short_key, const char* restrict key, 
+                 pmargp_type_t type, void* value_ptr, char *description, bool required) {
+    pmargp_spec_t spec = {
+        short_key, key, type, value_ptr, description,
+        required ? PMARGP_FLAG_REQUIRED : PMARGP_FLAG_OPTIONAL
+    };
+    return pmargp_add_arguments(parser, &spec, 1);
+}
+
+/*
+ * Choices
+ *
+ * A choice table is compiled when it is set. Up to PMARGP_CHOICE_HASH_MAX
+ * names are placed in a power-of-two slot array by a seeded mix of their
+ * key_hash, trying seeds, then wider arrays, until no two names share a
+ * slot; a lookup is then one hash, one slot and one compare. Larger tables,
+ * or the rare set whose FNV hashes collide outright, are sorted by name and
+ * binary searched instead.
+ */
+#define PMARGP_CHOICE_SEEDS 64
+#define PMARGP_CHOICE_MAX_SLOTS 4096
+
+struct pmargp_choices_t {
+    pmargp_choice_t *entries; // registration order when hashed, sorted by name otherwise
+    size_t count;
+    uint8_t *slots;           // entry index + 1 per slot, NULL for a sorted table
+    uint32_t seed;
+    uint32_t mask;
+};
+
+static inline uint32_t choice_slot(uint32_t hash, uint32_t seed, uint32_t mask) {
+    return (((hash ^ seed) * 2654435761u) >> 16) & mask;
+}
+
+static int choice_compare(const void *a, const void *b) {
+    return strcmp(((const pmargp_choice_t *)a)->name, ((const pmargp_choice_t *)b)->name);
+}
+
+// Place every entry with one seed, false on a collision. *duplicate is set
+// when the colliding names are equal, which no seed can fix.
+static bool choice_place(struct pmargp_choices_t *choices, const uint32_t *hashes, uint32_t seed,
+                         uint32_t mask, bool *duplicate) {
+    memset(choices->slots, 0, (size_t)mask + 1);
+    for (size_t i = 0; i < choices->count; i++) {
+        uint8_t *slot = &choices->slots[choice_slot(hashes[i], seed, mask)];
+        if (*slot) {
+            *duplicate = strcmp(choices->entries[*slot - 1].name, choices->entries[i].name) == 0;
+            return false;
+        }
+        *slot = (uint8_t)(i + 1);
+    }
+    return true;
+}
+
+static int choices_compile(pmargp_arena_t *arena, struct pmargp_choices_t *choices) {
+    if (choices->count <= PMARGP_CHOICE_HASH_MAX) {
+        arena_mark_t mark = arena_mark(arena);
+        uint32_t *hashes = arena_alloc(arena, (choices->count ? choices->count : 1) * sizeof(uint32_t));
+        if (!hashes) return PMARGP_ERR_MEMORY_ALLOCATION;
+        for (size_t i = 0; i < choices->count; i++) {
+            hashes[i] = key_hash(choices->entries[i].name, strlen(choices->entries[i].name));
+        }
+        arena_mark_t hashed = arena_mark(arena);
+        size_t slots = 4;
+        while (slots < choices->count * 4) slots *= 2;
+        for (; slots <= PMARGP_CHOICE_MAX_SLOTS; slots *= 2) {
+            arena_rewind(arena, hashed);  // a wider array replaces the last one
+            choices->slots = arena_alloc(arena, slots);
+            if (!choices->slots) return PMARGP_ERR_MEMORY_ALLOCATION;
+            for (uint32_t seed = 0; seed < PMARGP_CHOICE_SEEDS; seed++) {
+                bool duplicate = false;
+                if (choice_place(choices, hashes, seed * 0x9e3779b9u, (uint32_t)slots - 1, &duplicate)) {
+                    choices->seed = seed * 0x9e3779b9u;
+                    choices->mask = (uint32_t)slots - 1;
+                    return PMARGP_SUCCESS;
+                }
+                if (duplicate) return PMARGP_ERR_EXISTING_ARGUMENT;
+            }
+        }
+        arena_rewind(arena, mark);
+        choices->slots = NULL;
+    }
+    qsort(choices->entries, choices->count, sizeof(pmargp_choice_t), choice_compare);
+    for (size_t i = 1; i < choices->count; i++) {
+        if (strcmp(choices->entries[i - 1].name, choices->entries[i].name) == 0) return PMARGP_ERR_EXISTING_ARGUMENT;
+    }
+    return PMARGP_SUCCESS;
+}
+
+// Compare a NUL-terminated name with len bytes of text, strcmp style
+static inline int choice_order(const char *name, const char *text, size_t len) {
+    int order = strncmp(name, text, len);
+    return order ? order : (unsigned char)name[len];
+}
+
+static const pmargp_choice_t *choice_find(const struct pmargp_choices_t *choices, const char *text, size_t len) {
+    if (choices->slots) {
+        uint8_t slot = choices->slots[choice_slot(key_hash(text, len), choices->seed, choices->mask)];
+        const pmargp_choice_t *entry = slot ? &choices->entries[slot - 1] : NULL;
+        return entry && choice_order(entry->name, text, len) == 0 ? entry : NULL;
+    }
+    size_t lo = 0, hi = choices->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int order = choice_order(choices->entries[mid].name, text, len);
+        if (order == 0) return &choices->entries[mid];
+        if (order < 0) lo = mid + 1; else hi = mid;
     }
-    return false;
+    return NULL;
+}
+
+int pmargp_set_choices(struct pmargp_parser_t *parser, const char *key, const pmargp_choice_t *choices,
+                       size_t count) {
+    if (!parser || !key || (!choices && count)) return PMARGP_ERR_NULL;
+    if (parser->frozen) return PMARGP_ERR_FROZEN;
+    pmargp_argument_t *arg = get_argument(parser, key);
+    for (int i = 0; !arg && i < parser->positional_count; i++) {
+        if (strcmp(parser->args[parser->positionals[i]].name, key) == 0) arg = &parser->args[parser->positionals[i]];
+    }
+    if (!arg) return PMARGP_ERR_INVALID_KEY;
+    if (arg->type != PMARGP_CHOICE) return PMARGP_ERR_UNKNOWN_TYPE;
+
+    arena_mark_t mark = arena_mark(&parser->arena);
+    struct pmargp_choices_t *table = arena_alloc(&parser->arena, sizeof(*table));
+    pmargp_choice_t *entries = table ? arena_alloc(&parser->arena, count * sizeof(pmargp_choice_t)) : NULL;
+    if (!entries) {
+        arena_rewind(&parser->arena, mark);
+        return PMARGP_ERR_MEMORY_ALLOCATION;
+    }
+    for (size_t i = 0; i < count; i++) {
+        entries[i] = choices[i];
+        if (!entries[i].name) {
+            arena_rewind(&parser->arena, mark);
+            return PMARGP_ERR_NULL;
+        }
+        if (!(parser->flags & PMARGP_FLAG_BORROWED) && !(entries[i].name = arena_strdup(&parser->arena, choices[i].name))) {
+            arena_rewind(&parser->arena, mark);
+            return PMARGP_ERR_MEMORY_ALLOCATION;
+        }
+    }
+    table->entries = entries;
+    table->count = count;
+    table->slots = NULL;
+    table->seed = 0;
+    table->mask = 0;
+    int error = choices_compile(&parser->arena, table);
+    if (error != PMARGP_SUCCESS) {
+        if (error == PMARGP_ERR_EXISTING_ARGUMENT) fprintf(stderr, "Choice listed twice for %s\n", key);
+        arena_rewind(&parser->arena, mark);
+        return error;
+    }
+    arg->choices = table;
+    return PMARGP_SUCCESS;
 }
 
 static const char* type_to_string(pmargp_type_t type) {
@@ -163,9 +749,18 @@ static const char* type_to_string(pmargp_type_t type) {
         [PMARGP_RW_FILE] = "read-write file",
         [PMARGP_B_R_FILE] = "binary read file",
         [PMARGP_B_W_FILE] = "binary write file",
-        [PMARGP_B_RW_FILE] = "binary read-write file"
+        [PMARGP_B_RW_FILE] = "binary read-write file",
+        [PMARGP_INT64] = "int64",
+        [PMARGP_UINT64] = "uint64",
+        [PMARGP_SIZE] = "size",
+        [PMARGP_DOUBLE] = "double",
+        [PMARGP_MMAP_FILE] = "memory-mapped file",
+        [PMARGP_INT_LIST] = "int list",
+        [PMARGP_FLOAT_LIST] = "float list",
+        [PMARGP_DOUBLE_LIST] = "double list",
+        [PMARGP_CHOICE] = "choice"
     };
-    return (type >= 0 && type <= PMARGP_B_RW_FILE) ? type_strings[type] : "unknown";
+    return (type >= 0 && type <= PMARGP_CHOICE) ? type_strings[type] : "unknown";
 }
 
 static const char* type_to_token(pmargp_type_t type) {
@@ -180,166 +775,3091 @@ static const char* type_to_token(pmargp_type_t type) {
         [PMARGP_RW_FILE] = "<read_write_file>",
         [PMARGP_B_R_FILE] = "<binary_read_file>",
         [PMARGP_B_W_FILE] = "<binary_write_file>",
-        [PMARGP_B_RW_FILE] = "<binary_read_write_file>"
+        [PMARGP_B_RW_FILE] = "<binary_read_write_file>",
+        [PMARGP_INT64] = "<integer>",
+        [PMARGP_UINT64] = "<unsigned>",
+        [PMARGP_SIZE] = "<size>",
+        [PMARGP_DOUBLE] = "<double>",
+        [PMARGP_MMAP_FILE] = "<mmap_file>",
+        [PMARGP_INT_LIST] = "<integer,...>",
+        [PMARGP_FLOAT_LIST] = "<float,...>",
+        [PMARGP_DOUBLE_LIST] = "<double,...>",
+        [PMARGP_CHOICE] = "<choice>"
     };
-    return (type >= 0 && type <= PMARGP_B_RW_FILE) ? type_tokens[type] : "";
+    return (type >= 0 && type <= PMARGP_CHOICE) ? type_tokens[type] : "";
 }
 
-static void help(struct pmargp_parser_t *parser) {
-    if(!parser) return;
-    printf("\n%s\n", parser->name ? parser->name : "Program Name");
-    printf("%s\n\n", parser->description ? parser->description : "No description provided.");
-    printf("usage: %s [OPTIONS] \n\n", parser->name ? parser->name : "program");
+/*
+ * Help rendering
+ *
+ * The whole usage text is rendered in one pass into a caller buffer with
+ * snprintf semantics. The column widths are maintained by registration, so
+ * rendering never rescans the keys to size the columns.
+ */
+typedef struct {
+    char *buf;
+    size_t cap;
+    size_t len; // bytes the full text needs, may exceed cap
+} help_writer_t;
+
+static void put(help_writer_t *w, const char *s, size_t n) {
+    if (w->len < w->cap) {
+        size_t room = w->cap - w->len;
+        memcpy(w->buf + w->len, s, n < room ? n : room);
+    }
+    w->len += n;
+}
 
-    printf("Options:\n");
+static void put_str(help_writer_t *w, const char *s) {
+    put(w, s, strlen(s));
+}
 
-    int max_key_length = 0, max_short_key_length = 0;
-    for (int i = 0; i < parser->argc; i++) {
-        int key_length = parser->args[i].key ? strlen(parser->args[i].key) : 0;
-        int short_key_length = parser->args[i].short_key ? strlen(parser->args[i].short_key) : 0;
-        if (key_length > max_key_length) max_key_length = key_length;
-        if (short_key_length > max_short_key_length) max_short_key_length = short_key_length;
+// s left-aligned in a column of width, like "%-*s"
+static void put_column(help_writer_t *w, const char *s, int width) {
+    static const char spaces[] = "                                ";
+    size_t n = strlen(s);
+    put(w, s, n);
+    for (int pad = width - (int)n; pad > 0; pad -= (int)sizeof(spaces) - 1) {
+        put(w, spaces, pad < (int)sizeof(spaces) - 1 ? (size_t)pad : sizeof(spaces) - 1);
     }
+}
 
-    for (int i = 0; i < parser->argc; i++) {
-        const pmargp_argument_t *arg = &parser->args[i];
-        printf("  %-*s  %-*s%-15s%s",
-               max_key_length + 2, arg->key ? arg->key : "",
-               max_short_key_length + 2, arg->short_key ? arg->short_key : "",
-               type_to_token(arg->type),
-               arg->description ? arg->description : "No description");
-        printf(" (Type: %s) ", type_to_string(arg->type));
-        if (arg->value_ptr) {
-            switch (arg->type) {
-                case PMARGP_INT: printf("[Default: %d]", *(int*)arg->value_ptr); break;
-                case PMARGP_FLOAT: printf("[Default: %.2f]", *(float*)arg->value_ptr); break;
-                case PMARGP_BOOL: printf("[Default: %s]", *(bool*)arg->value_ptr ? "true" : "false"); break;
-                case PMARGP_STRING: printf("[Default: %s]", strlen(*(char**)arg->value_ptr) > 0 ?  *(char**)arg->value_ptr : "None"  ); break;
-                case PMARGP_CHAR: printf("[Default: %s]", strlen((char *)arg->value_ptr) > 0 ? (char *)arg->value_ptr : "None" ); break;
-                default: break;
+static void put_unsigned(help_writer_t *w, uint64_t value) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[sizeof(digits) - 1 - n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    put(w, digits + sizeof(digits) - n, (size_t)n);
+}
+
+static void put_signed(help_writer_t *w, int64_t value) {
+    if (value < 0) put(w, "-", 1);
+    put_unsigned(w, value < 0 ? (uint64_t)-(value + 1) + 1 : (uint64_t)value);
+}
+
+static void put_fixed(help_writer_t *w, double value) {
+    char text[512]; // "%.2f" of DBL_MAX is 312 characters
+    int n = snprintf(text, sizeof(text), "%.2f", value);
+    if (n > 0) put(w, text, (size_t)n);
+}
+
+static void put_default(help_writer_t *w, const pmargp_argument_t *arg) {
+    const void *value = arg->value_ptr;
+    switch (arg->type) {
+        case PMARGP_INT: put_signed(w, *(const int*)value); break;
+        case PMARGP_INT64: put_signed(w, *(const int64_t*)value); break;
+        case PMARGP_UINT64: put_unsigned(w, *(const uint64_t*)value); break;
+        case PMARGP_SIZE: put_unsigned(w, *(const size_t*)value); break;
+        case PMARGP_FLOAT: put_fixed(w, *(const float*)value); break;
+        case PMARGP_DOUBLE: put_fixed(w, *(const double*)value); break;
+        case PMARGP_BOOL: put_str(w, *(const bool*)value ? "true" : "false"); break;
+        case PMARGP_STRING: {
+            const char *s = *(char* const*)value;
+            put_str(w, s && *s ? s : "None");
+            break;
+        }
+        case PMARGP_CHAR: {
+            char c = *(const char*)value;
+            if (c) put(w, &c, 1); else put_str(w, "None");
+            break;
+        }
+        case PMARGP_CHOICE: {
+            int number = *(const int*)value;
+            const char *name = NULL;
+            for (size_t i = 0; arg->choices && !name && i < arg->choices->count; i++) {
+                if (arg->choices->entries[i].value == number) name = arg->choices->entries[i].name;
             }
+            if (name) put_str(w, name); else put_signed(w, number);
+            break;
         }
-        if (arg->required) printf(" [Required] ");
-        printf("\n");
+        default: return;
     }
-    printf("\n");
 }
 
-static const char *get_file_mode(pmargp_type_t type) {
-    switch (type) {
-        case PMARGP_R_FILE: return "r";
-        case PMARGP_W_FILE: return "w";
-        case PMARGP_RW_FILE: return "r+";
-        case PMARGP_B_R_FILE: return "rb";
-        case PMARGP_B_W_FILE: return "wb";
-        case PMARGP_B_RW_FILE: return "rb+";
-        default:
-            fprintf(stderr, "Error: Unknown file mode\n");
-            exit(EXIT_FAILURE);
+size_t pmargp_format_help(const struct pmargp_parser_t *parser, char *buf, size_t cap) {
+    help_writer_t w = {buf, buf ? cap : 0, 0};
+    if (parser) {
+        put_str(&w, "\n");
+        put_str(&w, parser->name ? parser->name : "Program Name");
+        put_str(&w, "\n");
+        put_str(&w, parser->description ? parser->description : "No description provided.");
+        put_str(&w, "\n\nusage: ");
+        put_str(&w, parser->name ? parser->name : "program");
+        put_str(&w, " [OPTIONS] ");
+        for (int i = 0; i < parser->positional_count; i++) {
+            const pmargp_argument_t *arg = &parser->args[parser->positionals[i]];
+            put_str(&w, arg->required ? "" : "[");
+            put_str(&w, arg->name);
+            put_str(&w, arg->required ? " " : "] ");
+        }
+        if (parser->command_count) put_str(&w, "<command> ");
+        if (parser->remainder) put_str(&w, "[...] ");
+        put_str(&w, "\n\nOptions:\n");
+
+        for (int i = 0; i < parser->argc; i++) {
+            const pmargp_argument_t *arg = &parser->args[i];
+            put_str(&w, "  ");
+            put_column(&w, arg->key ? arg->key : arg->name ? arg->name : "", parser->help_key_width + 2);
+            put_str(&w, "  ");
+            put_column(&w, arg->short_key ? arg->short_key : "", parser->help_short_width + 2);
+            put_column(&w, type_to_token(arg->type), 15);
+            put_str(&w, arg->description ? arg->description : "No description");
+            put_str(&w, " (Type: ");
+            put_str(&w, type_to_string(arg->type));
+            put_str(&w, ") ");
+            if (arg->value_ptr && arg->type != PMARGP_MMAP_FILE &&
+                (arg->type < PMARGP_INT_LIST || arg->type == PMARGP_CHOICE) &&
+                !(arg->type >= PMARGP_R_FILE && arg->type <= PMARGP_B_RW_FILE)) {
+                put_str(&w, "[Default: ");
+                put_default(&w, arg);
+                put_str(&w, "]");
+            }
+            if (arg->choices) {
+                put_str(&w, " [Choices: ");
+                for (size_t c = 0; c < arg->choices->count; c++) {
+                    if (c) put_str(&w, "|");
+                    put_str(&w, arg->choices->entries[c].name);
+                }
+                put_str(&w, "]");
+            }
+            if (arg->required) put_str(&w, " [Required] ");
+            put_str(&w, "\n");
+        }
+        if (parser->command_count) {
+            // listed from the registrations, none of the parsers is built
+            int width = 0;
+            for (int i = 0; i < parser->command_count; i++) {
+                int len = (int)strlen(parser->commands[i].name);
+                if (len > width) width = len;
+            }
+            put_str(&w, "\nCommands:\n");
+            for (int i = 0; i < parser->command_count; i++) {
+                put_str(&w, "  ");
+                put_column(&w, parser->commands[i].name, width + 2);
+                put_str(&w, parser->commands[i].description ? parser->commands[i].description : "No description");
+                put_str(&w, "\n");
+            }
+        }
+        put_str(&w, "\n");
     }
+    if (cap > 0 && buf) buf[w.len < cap ? w.len : cap - 1] = '\0';
+    return w.len;
 }
 
-int parses(struct pmargp_parser_t* parser, int argc, char* argv[]) {
-    if (!parser) return PMARGP_ERR_NULL;
-    if (parser->argc == 0) return PMARGP_ERR_NO_ARGUMENTS;
-    if (help_info(argc, argv)) {
-        help(parser);
-        free_parser(parser); // free parser for due diligence 
-        exit(EXIT_SUCCESS);
+static void help(struct pmargp_parser_t *parser) {
+    if(!parser) return;
+    char small[4096];
+    size_t len = pmargp_format_help(parser, small, sizeof(small));
+    if (len < sizeof(small)) {
+        fwrite(small, 1, len, stdout);
+        return;
     }
+    char *text = malloc(len + 1);
+    if (!text) return;
+    pmargp_format_help(parser, text, len + 1);
+    fwrite(text, 1, len, stdout);
+    free(text);
+}
 
-    char *endptr;
-    for (int i = 1; i < argc; i++) {
-        int idx = get_argument_index(parser, argv[i]);
-        if (idx == -1) continue;
-        pmargp_argument_t *arg = &parser->args[idx];
-        if (arg->allocated) continue;
-
-        if (arg->type == PMARGP_BOOL) {
-            *(bool*)arg->value_ptr = true;
-            arg->allocated = true;
-        } else if (i + 1 < argc) {
-            switch (arg->type) {
-                errno = 0; // error catch
-                case PMARGP_CHAR:
-                    *(char*)arg->value_ptr = *argv[++i];  
-                    break;
-                case PMARGP_STRING:
-                    *(char**)arg->value_ptr = argv[++i];
-                    break;
-                case PMARGP_FLOAT: 
-                    errno = 0;
-                    *(float*)arg->value_ptr = strtof(argv[++i], &endptr);
-                    if (errno == ERANGE || *endptr != '\0') {
-                        return PMARGP_ERR_INVALID_VALUE;
-                    }
-                    break;
-                case PMARGP_INT: 
-                    errno = 0;
-                    *(int*)arg->value_ptr = strtol(argv[++i], &endptr, 10);
-                    if (errno == ERANGE || *endptr != '\0') {
-                        return PMARGP_ERR_INVALID_VALUE;
-                    }
-                    break;
-                case PMARGP_R_FILE:
-                case PMARGP_W_FILE:
-                case PMARGP_RW_FILE:
-                case PMARGP_B_R_FILE:
-                case PMARGP_B_W_FILE:
-                case PMARGP_B_RW_FILE: {
-                    const char *mode = get_file_mode(arg->type);
-                    FILE *file = fopen(argv[++i], mode);
-                    if (file) {
-                        *(FILE**)arg->value_ptr = file;
-                    } else {
-                        fprintf(stderr, "Error opening file: %s\n", argv[i]);
-                        return PMARGP_ERR_FILE_OPEN;
-                    }
-                    break;
-                }
-                default:
-                    fprintf(stderr, "Unknown argument type for %s\n", arg->key);
-                    return PMARGP_ERR_UNKNOWN_TYPE;
-            }
-            arg->allocated = true;
+// --help on the command line: print the help and exit, or with
+// PMARGP_FLAG_NO_EXIT leave that to the caller.
+static int handle_help(struct pmargp_parser_t *parser) {
+    if (parser->flags & PMARGP_FLAG_NO_EXIT) return PMARGP_HELP_REQUESTED;
+    struct pmargp_parser_t *shown = parser;
+    while (shown->selected) shown = shown->selected;  // help of the command given
+    help(shown);
+    free_parser(parser); // free parser for due diligence
+    exit(EXIT_SUCCESS);
+}
 
-        }
-    }
+/*
+ * Numeric conversion
+ *
+ * Locale independent replacements for strtol/strtof. Integers are read eight
+ * digits at a time and range-checked exactly. Floating point follows the
+ * Eisel-Lemire algorithm (as in fast_float): a Clinger fast path for small
+ * exact inputs, then a 64x128-bit multiply against a truncated power of five
+ * that is provably enough to round correctly for up to 19 significant digits.
+ * Longer mantissas are decided by rounding both truncations and only fall
+ * back to strtod when they disagree.
+ */
+#define PMARGP_POW5_MIN (-342)
 
+static const uint64_t pow5_128[] = {
+    0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL,
+    0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL,
+    0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL,
+    0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL,
+    0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL,
+    0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL,
+    0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL,
+    0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL,
+    0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL,
+    0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL,
+    0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL,
+    0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL,
+    0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL,
+    0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL,
+    0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL,
+    0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL,
+    0x84a57695fe98746dULL, 0x014bb630f7604b57ULL,
+    0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL,
+    0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL,
+    0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL,
+    0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL,
+    0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL,
+    0xfd00b897478238d0ULL, 0x8920b098955522b4ULL,
+    0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL,
+    0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL,
+    0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL,
+    0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL,
+    0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL,
+    0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL,
+    0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL,
+    0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL,
+    0xeba09271e88d976bULL, 0xf7864a44c633682eULL,
+    0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL,
+    0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL,
+    0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL,
+    0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL,
+    0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL,
+    0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL,
+    0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL,
+    0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL,
+    0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL,
+    0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL,
+    0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL,
+    0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL,
+    0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL,
+    0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL,
+    0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL,
+    0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL,
+    0xa37fce126597973cULL, 0xe50ff107bab528a0ULL,
+    0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL,
+    0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL,
+    0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL,
+    0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL,
+    0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL,
+    0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL,
+    0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL,
+    0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL,
+    0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL,
+    0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL,
+    0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL,
+    0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL,
+    0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL,
+    0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL,
+    0x91376c36d99995beULL, 0x23100809b9c21fa1ULL,
+    0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL,
+    0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL,
+    0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL,
+    0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL,
+    0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL,
+    0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL,
+    0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL,
+    0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL,
+    0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL,
+    0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL,
+    0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL,
+    0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL,
+    0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL,
+    0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL,
+    0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL,
+    0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL,
+    0xc987434744ac874eULL, 0xa327ffb266b56220ULL,
+    0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL,
+    0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL,
+    0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL,
+    0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL,
+    0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL,
+    0xc0314325637a1939ULL, 0xfa911155fefb5308ULL,
+    0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL,
+    0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL,
+    0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL,
+    0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL,
+    0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL,
+    0xb749faed14125d36ULL, 0xcef980ec671f667bULL,
+    0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL,
+    0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL,
+    0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL,
+    0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL,
+    0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL,
+    0xaecc49914078536dULL, 0x58fae9f773886e18ULL,
+    0xda7f5bf590966848ULL, 0xaf39a475506a899eULL,
+    0x888f99797a5e012dULL, 0x6d8406c952429603ULL,
+    0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL,
+    0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL,
+    0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL,
+    0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL,
+    0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL,
+    0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL,
+    0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL,
+    0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL,
+    0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL,
+    0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL,
+    0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL,
+    0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL,
+    0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL,
+    0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL,
+    0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL,
+    0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL,
+    0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL,
+    0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL,
+    0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL,
+    0xb913179899f68584ULL, 0x28e2557b59846e3fULL,
+    0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL,
+    0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL,
+    0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL,
+    0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL,
+    0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL,
+    0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL,
+    0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL,
+    0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL,
+    0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL,
+    0xd77485cb25823ac7ULL, 0x7d633293366b828bULL,
+    0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL,
+    0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL,
+    0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL,
+    0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL,
+    0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL,
+    0xcd795be870516656ULL, 0x67902e276c921f8bULL,
+    0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL,
+    0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL,
+    0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL,
+    0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL,
+    0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL,
+    0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL,
+    0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL,
+    0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL,
+    0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL,
+    0xef340a98172aace4ULL, 0x86fb897116c87c34ULL,
+    0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL,
+    0xbae0a846d2195712ULL, 0x8974836059cca109ULL,
+    0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL,
+    0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL,
+    0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL,
+    0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL,
+    0x8e938662882af53eULL, 0x547eb47b7282ee9cULL,
+    0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL,
+    0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL,
+    0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL,
+    0xae0b158b4738705eULL, 0x9624ab50b148d445ULL,
+    0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL,
+    0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL,
+    0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL,
+    0xd47487cc8470652bULL, 0x7647c3200069671fULL,
+    0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL,
+    0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL,
+    0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL,
+    0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL,
+    0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL,
+    0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL,
+    0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL,
+    0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL,
+    0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL,
+    0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL,
+    0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL,
+    0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL,
+    0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL,
+    0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL,
+    0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL,
+    0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL,
+    0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL,
+    0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL,
+    0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL,
+    0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL,
+    0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL,
+    0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL,
+    0x8c974f7383725573ULL, 0x1e414218c73a13fbULL,
+    0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL,
+    0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL,
+    0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL,
+    0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL,
+    0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL,
+    0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL,
+    0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL,
+    0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL,
+    0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL,
+    0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL,
+    0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL,
+    0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL,
+    0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL,
+    0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL,
+    0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL,
+    0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL,
+    0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL,
+    0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL,
+    0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL,
+    0xbe89523386091465ULL, 0xf6bbb397f1135823ULL,
+    0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL,
+    0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL,
+    0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL,
+    0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL,
+    0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL,
+    0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL,
+    0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL,
+    0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL,
+    0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL,
+    0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL,
+    0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL,
+    0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL,
+    0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL,
+    0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL,
+    0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL,
+    0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL,
+    0x843610cb4bf160cbULL, 0xcedf722a585139baULL,
+    0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL,
+    0xce947a3da6a9273eULL, 0x733d226229feea32ULL,
+    0x811ccc668829b887ULL, 0x0806357d5a3f525fULL,
+    0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL,
+    0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL,
+    0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL,
+    0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL,
+    0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL,
+    0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL,
+    0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL,
+    0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL,
+    0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL,
+    0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL,
+    0xbbe226efb628afeaULL, 0x890489f70a55368bULL,
+    0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL,
+    0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL,
+    0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL,
+    0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL,
+    0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL,
+    0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL,
+    0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL,
+    0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL,
+    0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL,
+    0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL,
+    0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL,
+    0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL,
+    0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL,
+    0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL,
+    0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL,
+    0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL,
+    0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL,
+    0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL,
+    0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL,
+    0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL,
+    0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL,
+    0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL,
+    0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL,
+    0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL,
+    0xc24452da229b021bULL, 0xfbe85badce996168ULL,
+    0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL,
+    0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL,
+    0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL,
+    0xed246723473e3813ULL, 0x290123e9aab23b68ULL,
+    0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL,
+    0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL,
+    0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL,
+    0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL,
+    0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL,
+    0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL,
+    0x8d590723948a535fULL, 0x579c487e5a38ad0eULL,
+    0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL,
+    0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL,
+    0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL,
+    0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL,
+    0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL,
+    0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL,
+    0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL,
+    0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+    0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL,
+    0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+    0xcdb02555653131b6ULL, 0x3792f412cb06794dULL,
+    0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+    0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL,
+    0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+    0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL,
+    0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+    0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL,
+    0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+    0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL,
+    0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+    0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL,
+    0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+    0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL,
+    0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+    0x9226712162ab070dULL, 0xcab3961304ca70e8ULL,
+    0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+    0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL,
+    0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+    0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL,
+    0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+    0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL,
+    0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+    0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL,
+    0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+    0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL,
+    0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+    0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL,
+    0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+    0xcfb11ead453994baULL, 0x67de18eda5814af2ULL,
+    0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+    0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL,
+    0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+    0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL,
+    0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+    0xc612062576589ddaULL, 0x95364afe032a819eULL,
+    0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+    0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL,
+    0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+    0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL,
+    0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+    0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL,
+    0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+    0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL,
+    0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+    0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL,
+    0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+    0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL,
+    0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+    0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL,
+    0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+    0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL,
+    0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+    0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL,
+    0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+    0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL,
+    0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+    0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL,
+    0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+    0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL,
+    0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+    0x8000000000000000ULL, 0x0000000000000000ULL,
+    0xa000000000000000ULL, 0x0000000000000000ULL,
+    0xc800000000000000ULL, 0x0000000000000000ULL,
+    0xfa00000000000000ULL, 0x0000000000000000ULL,
+    0x9c40000000000000ULL, 0x0000000000000000ULL,
+    0xc350000000000000ULL, 0x0000000000000000ULL,
+    0xf424000000000000ULL, 0x0000000000000000ULL,
+    0x9896800000000000ULL, 0x0000000000000000ULL,
+    0xbebc200000000000ULL, 0x0000000000000000ULL,
+    0xee6b280000000000ULL, 0x0000000000000000ULL,
+    0x9502f90000000000ULL, 0x0000000000000000ULL,
+    0xba43b74000000000ULL, 0x0000000000000000ULL,
+    0xe8d4a51000000000ULL, 0x0000000000000000ULL,
+    0x9184e72a00000000ULL, 0x0000000000000000ULL,
+    0xb5e620f480000000ULL, 0x0000000000000000ULL,
+    0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+    0x8e1bc9bf04000000ULL, 0x0000000000000000ULL,
+    0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+    0xde0b6b3a76400000ULL, 0x0000000000000000ULL,
+    0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+    0xad78ebc5ac620000ULL, 0x0000000000000000ULL,
+    0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+    0x878678326eac9000ULL, 0x0000000000000000ULL,
+    0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+    0xd3c21bcecceda100ULL, 0x0000000000000000ULL,
+    0x84595161401484a0ULL, 0x0000000000000000ULL,
+    0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL,
+    0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+    0x813f3978f8940984ULL, 0x4000000000000000ULL,
+    0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+    0xc9f2c9cd04674edeULL, 0xa400000000000000ULL,
+    0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+    0x9dc5ada82b70b59dULL, 0xf020000000000000ULL,
+    0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+    0xf684df56c3e01bc6ULL, 0xc732000000000000ULL,
+    0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+    0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL,
+    0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+    0x96769950b50d88f4ULL, 0x1314448000000000ULL,
+    0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+    0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL,
+    0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+    0xb7abc627050305adULL, 0xf14a3d9e40000000ULL,
+    0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+    0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL,
+    0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+    0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL,
+    0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+    0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL,
+    0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+    0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL,
+    0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+    0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL,
+    0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+    0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL,
+    0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+    0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL,
+    0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+    0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL,
+    0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+    0x9f4f2726179a2245ULL, 0x01d762422c946590ULL,
+    0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+    0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL,
+    0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+    0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL,
+    0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL,
+    0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL,
+    0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL,
+    0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL,
+    0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL,
+    0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL,
+    0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL,
+    0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL,
+    0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL,
+    0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL,
+    0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL,
+    0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL,
+    0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL,
+    0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL,
+    0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL,
+    0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL,
+    0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL,
+    0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL,
+    0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL,
+    0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL,
+    0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL,
+    0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL,
+    0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL,
+    0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL,
+    0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL,
+    0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL,
+    0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL,
+    0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL,
+    0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL,
+    0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL,
+    0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL,
+    0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL,
+    0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL,
+    0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL,
+    0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL,
+    0x924d692ca61be758ULL, 0x593c2626705f9c56ULL,
+    0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL,
+    0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL,
+    0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL,
+    0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL,
+    0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL,
+    0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL,
+    0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL,
+    0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL,
+    0x884134fe908658b2ULL, 0x3109058d147fdcddULL,
+    0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL,
+    0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL,
+    0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL,
+    0xa6539930bf6bff45ULL, 0x84db8346b786151cULL,
+    0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL,
+    0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL,
+    0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL,
+    0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL,
+    0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL,
+    0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL,
+    0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL,
+    0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL,
+    0x9ae757596946075fULL, 0x3375788de9b06958ULL,
+    0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL,
+    0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL,
+    0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL,
+    0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL,
+    0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL,
+    0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL,
+    0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL,
+    0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL,
+    0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL,
+    0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL,
+    0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL,
+    0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL,
+    0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL,
+    0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL,
+    0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL,
+    0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL,
+    0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL,
+    0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL,
+    0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL,
+    0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL,
+    0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL,
+    0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL,
+    0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL,
+    0x802221226be55a64ULL, 0xc2494954da2c9789ULL,
+    0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL,
+    0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL,
+    0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL,
+    0x9c69a97284b578d7ULL, 0xff2a760414536efbULL,
+    0xc38413cf25e2d70dULL, 0xfef5138519684abaULL,
+    0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL,
+    0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL,
+    0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL,
+    0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL,
+    0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL,
+    0xba756174393d88dfULL, 0x94f971119aeef9e4ULL,
+    0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL,
+    0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL,
+    0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL,
+    0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL,
+    0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL,
+    0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL,
+    0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL,
+    0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL,
+    0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL,
+    0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL,
+    0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL,
+    0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL,
+    0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL,
+    0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL,
+    0xa59bc234db398c25ULL, 0x43fab9837e699095ULL,
+    0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL,
+    0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL,
+    0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL,
+    0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL,
+    0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL,
+    0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL,
+    0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL,
+    0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL,
+    0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL,
+    0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL,
+    0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL,
+    0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL,
+    0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL,
+    0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL,
+    0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL,
+    0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL,
+    0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL,
+    0x8fa475791a569d10ULL, 0xf96e017d694487bcULL,
+    0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL,
+    0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL,
+    0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL,
+    0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL,
+    0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL,
+    0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL,
+    0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL,
+    0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL,
+    0x85c7056562757456ULL, 0xf6872d5667844e49ULL,
+    0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL,
+    0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL,
+    0x82a45b450226b39cULL, 0xecc0024661173473ULL,
+    0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL,
+    0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL,
+    0xff290242c83396ceULL, 0x7e67047175a15271ULL,
+    0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL,
+    0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL,
+    0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL,
+    0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL,
+    0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL,
+    0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL,
+    0x98165af37b2153deULL, 0xc3727a337a8b704aULL,
+    0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL,
+    0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL,
+    0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL,
+    0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL,
+    0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL,
+    0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL,
+    0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL,
+    0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL,
+    0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL,
+    0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL,
+    0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL,
+    0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL,
+    0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL,
+    0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL,
+    0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL,
+    0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL,
+    0xd31045a8341ca07cULL, 0x1ede48111209a050ULL,
+    0x83ea2b892091e44dULL, 0x934aed0aab460432ULL,
+    0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL,
+    0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL,
+    0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL,
+    0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL,
+    0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL,
+    0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL,
+    0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL,
+    0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL,
+    0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL,
+    0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL,
+    0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL,
+    0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL,
+    0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL,
+    0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL,
+    0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL,
+    0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL,
+    0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL,
+    0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL,
+    0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL,
+    0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL,
+    0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL,
+    0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL,
+    0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL,
+    0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL,
+    0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL,
+    0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL,
+    0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL,
+    0x8533285c936b35deULL, 0xd53a88958f87275fULL,
+    0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL,
+    0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL,
+    0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL,
+    0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL,
+    0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL,
+    0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL,
+    0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL,
+    0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL,
+    0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL,
+    0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL,
+    0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL,
+    0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL,
+    0x976e41088617ca01ULL, 0xd5be0503e085d813ULL,
+    0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL,
+    0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL,
+    0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL,
+    0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL,
+    0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL,
+    0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL,
+    0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL,
+    0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL,
+    0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL,
+    0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL,
+    0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL,
+    0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL,
+    0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL,
+    0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL,
+    0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL,
+    0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL,
+    0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL,
+    0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL,
+    0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL,
+    0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL,
+    0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL,
+    0xa0555e361951c366ULL, 0xd7e105bcc332621fULL,
+    0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL,
+    0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL,
+    0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL,
+    0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL,
+    0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL,
+    0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL,
+    0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL,
+    0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL,
+    0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL,
+    0xbaa718e68396cffdULL, 0xd30560258f54e6baULL,
+    0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL,
+    0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL,
+    0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL,
+    0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL,
+    0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL,
+};
 
-    for (int j = 0; j < parser->argc; j++) {
-        pmargp_argument_t *arg = &parser->args[j];
-        if (arg->required && !arg->allocated) {
-            return PMARGP_ERR_ARG_MISSING;
-        }
-    }
+typedef struct {
+    int mantissa_bits;          // explicit mantissa bits
+    int minimum_exponent;       // -bias
+    int infinite_power;         // biased exponent of infinity
+    int smallest_power_of_ten;  // below this everything rounds to zero
+    int largest_power_of_ten;   // above this everything rounds to infinity
+    int min_round_to_even;      // range of q where exact halfway cases exist
+    int max_round_to_even;
+    int max_fast_exponent;      // Clinger fast path limits
+    uint64_t max_fast_mantissa;
+} float_format_t;
 
-    return PMARGP_SUCCESS;
+static const float_format_t double_format = {52, -1023, 0x7FF, -342, 308, -4, 23, 22, (uint64_t)2 << 52};
+static const float_format_t single_format = {23, -127, 0xFF, -65, 38, -17, 10, 10, (uint64_t)2 << 23};
+
+typedef struct {
+    uint64_t high;
+    uint64_t low;
+} u128_t;
+
+static inline u128_t full_multiplication(uint64_t a, uint64_t b) {
+    u128_t r;
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 p = (unsigned __int128)a * b;
+    r.high = (uint64_t)(p >> 64);
+    r.low = (uint64_t)p;
+#else
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32, b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+    r.high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    r.low = (cross << 32) | (uint32_t)lo_lo;
+#endif
+    return r;
 }
 
-void parser_start(struct pmargp_parser_t *parser) {
-    if (parser) {
-        parser->argc = 0;
-        parser->args = NULL;
-        parser->name = NULL;
-        parser->description = NULL;
-        parser->add_argument = add_argument;
-        parser->parses = parses;
-        parser->get_argument = get_argument;
-        parser->get_argument_index = get_argument_index;
+static inline int leading_zeroes(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & ((uint64_t)1 << 63))) {
+        x <<= 1;
+        n++;
     }
+    return n;
+#endif
 }
 
-void free_parser(struct pmargp_parser_t *parser) {
-    if (!parser) return;
+static inline int trailing_zeroes(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline bool is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Little-endian assembly of eight bytes; compilers turn this into one load.
+static inline uint64_t read_u64(const char *p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | (unsigned char)p[i];
+    return v;
+}
+
+static inline bool is_eight_digits(uint64_t v) {
+    return (((v & 0xF0F0F0F0F0F0F0F0ULL) | (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+            0x3333333333333333ULL);
+}
+
+static inline uint32_t parse_eight_digits(uint64_t v) {
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 0x000F424000000064ULL; // 100 + (1000000ULL << 32)
+    const uint64_t mul2 = 0x0000271000000001ULL; // 1 + (10000ULL << 32)
+    v -= 0x3030303030303030ULL;
+    v = (v * 10) + (v >> 8);
+    v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t)v;
+}
 
-    for (int j = 0; j < parser->argc; j++) {
-        pmargp_argument_t *arg = &parser->args[j];
-        if (arg->key != NULL) free(arg->key);
-        if (arg->short_key != NULL) free(arg->short_key);
-        if (arg->description != NULL) free(arg->description);
+// Accumulate the digits in [p, end) into *value, eight at a time while
+// possible. Returns the first non-digit. Wraps silently, callers count digits.
+static inline const char *scan_digits(const char *p, const char *end, uint64_t *value) {
+    uint64_t v = *value;
+    while (end - p >= 8 && is_eight_digits(read_u64(p))) {
+        v = v * 100000000ULL + parse_eight_digits(read_u64(p));
+        p += 8;
     }
-    free(parser->args);
+    while (p < end && is_digit(*p)) {
+        v = v * 10 + (uint64_t)(*p - '0');
+        p++;
+    }
+    *value = v;
+    return p;
+}
+
+// Parse an unsigned decimal magnitude that must span the whole of [p, end).
+static int parse_magnitude(const char *p, const char *end, uint64_t *out) {
+    if (p == end) return PMARGP_ERR_INVALID_VALUE;
+    while (p < end && *p == '0') p++;
+
+    uint64_t value = 0;
+    const char *digits = p;
+    const char *stop = scan_digits(p, end, &value);
+    if (stop != end) return PMARGP_ERR_INVALID_VALUE;
+
+    size_t count = (size_t)(stop - digits);
+    if (count > 20) return PMARGP_ERR_INVALID_VALUE;
+    if (count == 20) {
+        // the first 19 digits always fit, only the last one can overflow
+        uint64_t head = 0;
+        scan_digits(digits, digits + 19, &head);
+        unsigned last = (unsigned)(digits[19] - '0');
+        if (head > UINT64_MAX / 10 || (head == UINT64_MAX / 10 && last > UINT64_MAX % 10)) {
+            return PMARGP_ERR_INVALID_VALUE;
+        }
+    }
+    *out = value;
+    return PMARGP_SUCCESS;
+}
+
+static int parse_signed(const char *s, size_t len, int64_t min, int64_t max, int64_t *out) {
+    const char *end = s + len;
+    while (s < end && is_space(*s)) s++;
+    bool negative = s < end && *s == '-';
+    if (s < end && (*s == '-' || *s == '+')) s++;
+
+    uint64_t magnitude;
+    if (parse_magnitude(s, end, &magnitude) != PMARGP_SUCCESS) return PMARGP_ERR_INVALID_VALUE;
+    if (negative) {
+        if (magnitude > (uint64_t)-(min + 1) + 1) return PMARGP_ERR_INVALID_VALUE;
+        *out = magnitude == 0 ? 0 : -(int64_t)(magnitude - 1) - 1;
+    } else {
+        if (magnitude > (uint64_t)max) return PMARGP_ERR_INVALID_VALUE;
+        *out = (int64_t)magnitude;
+    }
+    return PMARGP_SUCCESS;
+}
+
+static int parse_unsigned(const char *s, size_t len, uint64_t max, uint64_t *out) {
+    const char *end = s + len;
+    while (s < end && is_space(*s)) s++;
+    if (s < end && *s == '+') s++;
+
+    uint64_t magnitude;
+    if (parse_magnitude(s, end, &magnitude) != PMARGP_SUCCESS || magnitude > max) {
+        return PMARGP_ERR_INVALID_VALUE;
+    }
+    *out = magnitude;
+    return PMARGP_SUCCESS;
+}
+
+typedef struct {
+    uint64_t mantissa;
+    int power2;       // biased exponent
+} adjusted_mantissa_t;
+
+static adjusted_mantissa_t compute_float(const float_format_t *format, int64_t q, uint64_t w) {
+    adjusted_mantissa_t answer = {0, 0};
+    if (w == 0 || q < format->smallest_power_of_ten) return answer;
+    if (q > format->largest_power_of_ten) {
+        answer.power2 = format->infinite_power;
+        return answer;
+    }
+
+    int lz = leading_zeroes(w);
+    w <<= lz;
+
+    // Approximate w * 5^q with 128 bits, widening to the second table word only
+    // when the bits below the ones we keep could carry into them.
+    size_t index = 2 * (size_t)(q - PMARGP_POW5_MIN);
+    u128_t product = full_multiplication(w, pow5_128[index]);
+    uint64_t precision_mask = UINT64_MAX >> (format->mantissa_bits + 3);
+    if ((product.high & precision_mask) == precision_mask) {
+        u128_t second = full_multiplication(w, pow5_128[index + 1]);
+        product.low += second.high;
+        if (second.high > product.low) product.high++;
+    }
+
+    int upperbit = (int)(product.high >> 63);
+    int shift = upperbit + 64 - format->mantissa_bits - 3;
+    answer.mantissa = product.high >> shift;
+    // floor(log2(10^q)) + 63, valid for |q| < 1700
+    int power = (int)((((152170 + 65536) * q) >> 16) + 63);
+    answer.power2 = power + upperbit - lz - format->minimum_exponent;
+
+    if (answer.power2 <= 0) { // subnormal
+        if (-answer.power2 + 1 >= 64) {
+            answer.power2 = 0;
+            answer.mantissa = 0;
+            return answer;
+        }
+        answer.mantissa >>= -answer.power2 + 1;
+        answer.mantissa += answer.mantissa & 1;
+        answer.mantissa >>= 1;
+        answer.power2 = answer.mantissa < ((uint64_t)1 << format->mantissa_bits) ? 0 : 1;
+        return answer;
+    }
+
+    // Round half to even: only exact halfway cases, which can only occur for
+    // small q, must not round up.
+    if (product.low <= 1 && q >= format->min_round_to_even && q <= format->max_round_to_even &&
+        (answer.mantissa & 3) == 1 && (answer.mantissa << shift) == product.high) {
+        answer.mantissa &= ~(uint64_t)1;
+    }
+    answer.mantissa += answer.mantissa & 1;
+    answer.mantissa >>= 1;
+    if (answer.mantissa >= ((uint64_t)2 << format->mantissa_bits)) {
+        answer.mantissa = (uint64_t)1 << format->mantissa_bits;
+        answer.power2++;
+    }
+    answer.mantissa &= ~((uint64_t)1 << format->mantissa_bits);
+    if (answer.power2 >= format->infinite_power) {
+        answer.power2 = format->infinite_power;
+        answer.mantissa = 0;
+    }
+    return answer;
+}
+
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+#define PMARGP_CLINGER_FAST_PATH 1
+static const double exact_powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#endif
+
+// Significant digits handed to strtod by parse_float_slow. 768 decimal
+// digits settle the rounding of any binary64 value, past them only whether
+// a nonzero digit follows still matters.
+#define PMARGP_SLOW_DIGITS 768
+
+static int digit_value(char c, bool hex) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (!hex) return -1;
+    c = c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+    return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+// strtod/strtof for the rare inputs the fast paths cannot settle (hexadecimal
+// floats, >19 digit mantissas right on a rounding boundary). The token is
+// rewritten on the stack as an integer significand and an exponent, without
+// a decimal point, so LC_NUMERIC cannot change the result and nothing is
+// allocated. Digits past PMARGP_SLOW_DIGITS are folded into a final '1' when
+// any of them is nonzero, which rounds the same way.
+static int parse_float_slow(const float_format_t *format, const char *s, size_t len, uint64_t *bits) {
+    const char *end = s + len;
+    char buffer[PMARGP_SLOW_DIGITS + 32];
+    char *out = buffer;
+    if (s < end && (*s == '-' || *s == '+')) *out++ = *s++;
+    bool hex = end - s >= 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X');
+    if (hex) {
+        s += 2;
+        *out++ = '0';
+        *out++ = 'x';
+    }
+
+    // The significand written out is scaled by radix^scale
+    int64_t scale = 0;
+    size_t digits = 0, kept = 0;
+    bool point = false, sticky = false;
+    for (; s < end; s++) {
+        if (*s == '.' && !point) {
+            point = true;
+            continue;
+        }
+        int digit = digit_value(*s, hex);
+        if (digit < 0) break;
+        digits++;
+        if (kept < PMARGP_SLOW_DIGITS && (kept || digit)) {
+            *out++ = *s;
+            kept++;
+            scale -= point;
+        } else if (kept) {
+            sticky |= digit != 0;
+            scale += !point;
+        } else {
+            scale -= point;
+        }
+    }
+    if (digits == 0) return PMARGP_ERR_INVALID_VALUE;
+    if (sticky) {
+        *out++ = '1';
+        scale--;
+    }
+    if (kept == 0) *out++ = '0';
+
+    int64_t exponent = 0;
+    if (s < end && (*s == (hex ? 'p' : 'e') || *s == (hex ? 'P' : 'E'))) {
+        s++;
+        bool negative_exponent = s < end && *s == '-';
+        if (s < end && (*s == '-' || *s == '+')) s++;
+        if (s == end || !is_digit(*s)) return PMARGP_ERR_INVALID_VALUE;
+        for (; s < end && is_digit(*s); s++) {
+            if (exponent < 1000000000000000LL) exponent = exponent * 10 + (*s - '0');
+        }
+        if (negative_exponent) exponent = -exponent;
+    }
+    if (s != end) return PMARGP_ERR_INVALID_VALUE;
+    // A hexadecimal exponent is binary, four bits per digit
+    exponent += hex ? 4 * scale : scale;
+    snprintf(out, sizeof(buffer) - (size_t)(out - buffer), "%c%lld", hex ? 'p' : 'e', (long long)exponent);
+
+    // ERANGE also flags inexact subnormals, which are valid results; only
+    // an overflow to infinity or an underflow to zero is out of range
+    char *stop;
+    bool out_of_range;
+    errno = 0;
+    if (format->mantissa_bits == 52) {
+        double value = strtod(buffer, &stop);
+        out_of_range = errno == ERANGE && (value == 0.0 || value == HUGE_VAL || value == -HUGE_VAL);
+        memcpy(bits, &value, sizeof(value));
+    } else {
+        float value = strtof(buffer, &stop);
+        out_of_range = errno == ERANGE && (value == 0.0f || value == HUGE_VALF || value == -HUGE_VALF);
+        uint32_t word;
+        memcpy(&word, &value, sizeof(value));
+        *bits = word;
+    }
+    return *stop == '\0' && !out_of_range ? PMARGP_SUCCESS : PMARGP_ERR_INVALID_VALUE;
+}
+
+static bool match_word(const char *s, const char *end, const char *word) {
+    for (; *word; s++, word++) {
+        if (s == end) return false;
+        char c = *s >= 'A' && *s <= 'Z' ? (char)(*s - 'A' + 'a') : *s;
+        if (c != *word) return false;
+    }
+    return s == end;
+}
+
+// Parse a whole token as a decimal floating point number in the given format.
+// *bits receives the IEEE-754 encoding (binary64 or binary32).
+static int parse_float_bits(const float_format_t *format, const char *s, size_t len, uint64_t *bits) {
+    const char *end = s + len;
+    while (s < end && is_space(*s)) s++;
+    const char *start = s;
+    bool negative = s < end && *s == '-';
+    if (s < end && (*s == '-' || *s == '+')) s++;
+    uint64_t sign = (uint64_t)negative << (format->mantissa_bits + (format->mantissa_bits == 52 ? 11 : 8));
+    uint64_t infinity = (uint64_t)format->infinite_power << format->mantissa_bits;
+
+    if (match_word(s, end, "inf") || match_word(s, end, "infinity")) {
+        *bits = sign | infinity;
+        return PMARGP_SUCCESS;
+    }
+    if (match_word(s, end, "nan")) {
+        *bits = sign | infinity | ((uint64_t)1 << (format->mantissa_bits - 1));
+        return PMARGP_SUCCESS;
+    }
+    if (end - s >= 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        return parse_float_slow(format, start, (size_t)(end - start), bits);
+    }
+
+    uint64_t mantissa = 0;
+    const char *int_start = s;
+    const char *int_end = scan_digits(s, end, &mantissa);
+    const char *frac_start = int_end, *frac_end = int_end;
+    if (int_end < end && *int_end == '.') {
+        frac_start = int_end + 1;
+        frac_end = scan_digits(frac_start, end, &mantissa);
+    }
+    int64_t digit_count = (int64_t)(int_end - int_start) + (int64_t)(frac_end - frac_start);
+    if (digit_count == 0) return PMARGP_ERR_INVALID_VALUE;
+
+    const char *p = frac_end;
+    int64_t explicit_exponent = 0;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negative_exponent = p < end && *p == '-';
+        if (p < end && (*p == '-' || *p == '+')) p++;
+        if (p == end || !is_digit(*p)) return PMARGP_ERR_INVALID_VALUE;
+        for (; p < end && is_digit(*p); p++) {
+            if (explicit_exponent < 0x10000000) explicit_exponent = explicit_exponent * 10 + (*p - '0');
+        }
+        if (negative_exponent) explicit_exponent = -explicit_exponent;
+    }
+    if (p != end) return PMARGP_ERR_INVALID_VALUE;
+    int64_t exponent = explicit_exponent - (int64_t)(frac_end - frac_start);
+
+    // More than 19 significant digits: keep the first 19 and remember that
+    // the true mantissa lies between that and the next integer.
+    bool truncated = false;
+    if (digit_count > 19) {
+        for (const char *c = int_start; c < frac_end && (*c == '0' || *c == '.'); c++) {
+            if (*c == '0') digit_count--;
+        }
+        if (digit_count > 19) {
+            const uint64_t nineteen_digits = 1000000000000000000ULL;
+            truncated = true;
+            mantissa = 0;
+            const char *c = int_start;
+            while (mantissa < nineteen_digits && c != int_end) mantissa = mantissa * 10 + (uint64_t)(*c++ - '0');
+            if (mantissa >= nineteen_digits) {
+                exponent = explicit_exponent + (int64_t)(int_end - c);
+            } else {
+                c = frac_start;
+                while (mantissa < nineteen_digits && c != frac_end) mantissa = mantissa * 10 + (uint64_t)(*c++ - '0');
+                exponent = explicit_exponent - (int64_t)(c - frac_start);
+            }
+        }
+    }
+
+#ifdef PMARGP_CLINGER_FAST_PATH
+    if (!truncated && exponent >= -format->max_fast_exponent && exponent <= format->max_fast_exponent &&
+        mantissa <= format->max_fast_mantissa) {
+        if (format->mantissa_bits == 52) {
+            double value = (double)mantissa;
+            value = exponent < 0 ? value / exact_powers_of_ten[-exponent] : value * exact_powers_of_ten[exponent];
+            if (negative) value = -value;
+            memcpy(bits, &value, sizeof(value));
+        } else {
+            float value = (float)mantissa;
+            float power = (float)exact_powers_of_ten[exponent < 0 ? -exponent : exponent];
+            value = exponent < 0 ? value / power : value * power;
+            if (negative) value = -value;
+            uint32_t word;
+            memcpy(&word, &value, sizeof(value));
+            *bits = word;
+        }
+        return PMARGP_SUCCESS;
+    }
+#endif
+
+    adjusted_mantissa_t am = compute_float(format, exponent, mantissa);
+    if (truncated) {
+        adjusted_mantissa_t above = compute_float(format, exponent, mantissa + 1);
+        if (above.mantissa != am.mantissa || above.power2 != am.power2) {
+            return parse_float_slow(format, start, (size_t)(end - start), bits);
+        }
+    }
+
+    if (am.power2 == format->infinite_power) return PMARGP_ERR_INVALID_VALUE; // overflow
+    if (am.power2 == 0 && am.mantissa == 0 && mantissa != 0) return PMARGP_ERR_INVALID_VALUE; // underflow
+    *bits = sign | am.mantissa | ((uint64_t)am.power2 << format->mantissa_bits);
+    return PMARGP_SUCCESS;
+}
+
+static int parse_double(const char *s, size_t len, double *out) {
+    uint64_t bits;
+    int error = parse_float_bits(&double_format, s, len, &bits);
+    if (error == PMARGP_SUCCESS) memcpy(out, &bits, sizeof(*out));
+    return error;
+}
+
+static int parse_float(const char *s, size_t len, float *out) {
+    uint64_t bits;
+    int error = parse_float_bits(&single_format, s, len, &bits);
+    if (error == PMARGP_SUCCESS) {
+        uint32_t word = (uint32_t)bits;
+        memcpy(out, &word, sizeof(*out));
+    }
+    return error;
+}
+
+// Boolean values from the environment and config files. On the command line
+// a boolean takes no value, its key alone sets it.
+static int parse_bool(const char *s, size_t len, bool *out) {
+    const char *end = s + len;
+    if (match_word(s, end, "1") || match_word(s, end, "true") || match_word(s, end, "yes") ||
+        match_word(s, end, "on")) {
+        *out = true;
+    } else if (match_word(s, end, "0") || match_word(s, end, "false") || match_word(s, end, "no") ||
+               match_word(s, end, "off")) {
+        *out = false;
+    } else {
+        return PMARGP_ERR_INVALID_VALUE;
+    }
+    return PMARGP_SUCCESS;
+}
+
+
+/*
+ * Numeric lists
+ *
+ * A list value is split in two passes over the text. The first counts the
+ * delimiters so that the array can be allocated at its exact size; the second
+ * walks the delimiter positions and converts each element in place with the
+ * scalar parsers above. Both passes look at 32 bytes at a time, turning them
+ * into a bitmask of delimiter positions with AVX2 or SSE2 compares where the
+ * target has them, and a plain loop otherwise.
+ */
+#define LIST_BLOCK 32
+
+static inline uint32_t delimiter_mask(const char *p, char delimiter) {
+#if defined(__AVX2__)
+    __m256i block = _mm256_loadu_si256((const __m256i *)p);
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(delimiter)));
+#elif defined(__SSE2__)
+    __m128i d = _mm_set1_epi8(delimiter);
+    uint32_t lo = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)p), d));
+    uint32_t hi = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(p + 16)), d));
+    return lo | (hi << 16);
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < LIST_BLOCK; i++) mask |= (uint32_t)(p[i] == delimiter) << i;
+    return mask;
+#endif
+}
+
+static inline int popcount32(uint32_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcount(x);
+#else
+    x = x - ((x >> 1) & 0x55555555u);
+    x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+    return (int)((((x + (x >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+#endif
+}
+
+static size_t count_delimiters(const char *s, size_t len, char delimiter) {
+    size_t count = 0, i = 0;
+    for (; i + LIST_BLOCK <= len; i += LIST_BLOCK) count += (size_t)popcount32(delimiter_mask(s + i, delimiter));
+    for (; i < len; i++) count += s[i] == delimiter;
+    return count;
+}
+
+static int convert_element(pmargp_type_t type, const char *s, size_t len, void *items, size_t n) {
+    switch (type) {
+        case PMARGP_INT_LIST: {
+            int64_t number;
+            if (parse_signed(s, len, INT_MIN, INT_MAX, &number) != PMARGP_SUCCESS) return PMARGP_ERR_INVALID_VALUE;
+            ((int *)items)[n] = (int)number;
+            return PMARGP_SUCCESS;
+        }
+        case PMARGP_FLOAT_LIST:
+            return parse_float(s, len, (float *)items + n);
+        default:
+            return parse_double(s, len, (double *)items + n);
+    }
+}
+
+// Convert the elements of s into items, which has room for all of them. On
+// failure *failed is the element that did not convert.
+static int convert_list(pmargp_type_t type, const char *s, size_t len, char delimiter, void *items, size_t *failed) {
+    size_t n = 0, start = 0, i = 0;
+    for (; i + LIST_BLOCK <= len; i += LIST_BLOCK) {
+        for (uint32_t mask = delimiter_mask(s + i, delimiter); mask; mask &= mask - 1) {
+            size_t end = i + (size_t)trailing_zeroes(mask);
+            if (convert_element(type, s + start, end - start, items, n) != PMARGP_SUCCESS) {
+                *failed = n;
+                return PMARGP_ERR_INVALID_VALUE;
+            }
+            n++;
+            start = end + 1;
+        }
+    }
+    for (; i <= len; i++) {
+        if (i < len && s[i] != delimiter) continue;
+        if (convert_element(type, s + start, i - start, items, n) != PMARGP_SUCCESS) {
+            *failed = n;
+            return PMARGP_ERR_INVALID_VALUE;
+        }
+        n++;
+        start = i + 1;
+    }
+    return PMARGP_SUCCESS;
+}
+
+static size_t list_element_size(pmargp_type_t type) {
+    return type == PMARGP_INT_LIST ? sizeof(int) : type == PMARGP_FLOAT_LIST ? sizeof(float) : sizeof(double);
+}
+
+
+static const char *get_file_mode(pmargp_type_t type) {
+    switch (type) {
+        case PMARGP_R_FILE: return "r";
+        case PMARGP_W_FILE: return "w";
+        case PMARGP_RW_FILE: return "r+";
+        case PMARGP_B_R_FILE: return "rb";
+        case PMARGP_B_W_FILE: return "wb";
+        case PMARGP_B_RW_FILE: return "rb+";
+        default:
+            fprintf(stderr, "Error: Unknown file mode\n");
+            exit(EXIT_FAILURE);
+    }
+}
+
+// Map a whole regular file. Empty files succeed with *data == NULL, since
+// mmap rejects a length of zero. Writable mappings are private, so writes
+// never reach the file.
+static int map_path(const char *path, bool writable, void **data, size_t *size) {
+#ifdef PMARGP_HAVE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return PMARGP_ERR_FILE_OPEN;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return PMARGP_ERR_FILE_OPEN;
+    }
+    *size = (size_t)st.st_size;
+    *data = NULL;
+    if (*size) {
+        int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        *data = mmap(NULL, *size, protection, MAP_PRIVATE, fd, 0);
+    }
+    close(fd); // the mapping keeps its own reference
+    return *data == MAP_FAILED ? PMARGP_ERR_FILE_OPEN : PMARGP_SUCCESS;
+#else
+    (void)path;
+    (void)writable;
+    (void)data;
+    (void)size;
+    return PMARGP_ERR_FILE_OPEN;
+#endif
+}
+
+static void unmap_path(void *data, size_t size) {
+#ifdef PMARGP_HAVE_MMAP
+    if (data) munmap(data, size);
+#else
+    (void)data;
+    (void)size;
+#endif
+}
+
+static int map_file(const char *path, pmargp_mmap_t *view) {
+    void *data;
+    size_t size;
+    if (map_path(path, false, &data, &size) != PMARGP_SUCCESS) return PMARGP_ERR_FILE_OPEN;
+#ifdef PMARGP_HAVE_MMAP
+    if (data) {
+        // Hints only tune paging, so failures are not errors
+        if (view->advice & PMARGP_MADV_SEQUENTIAL) madvise(data, size, MADV_SEQUENTIAL);
+        if (view->advice & PMARGP_MADV_WILLNEED) madvise(data, size, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+        if (view->advice & PMARGP_MADV_HUGEPAGE) madvise(data, size, MADV_HUGEPAGE);
+#endif
+    }
+#endif
+    view->data = data ? data : (const unsigned char *)"";
+    view->size = size;
+    return PMARGP_SUCCESS;
+}
+
+static void unmap_file(pmargp_mmap_t *view) {
+    if (view->size) unmap_path((void *)view->data, view->size);
+    view->data = NULL;
+    view->size = 0;
+}
+
+/*
+ * In-place tokenizer
+ *
+ * Splits text into words with POSIX shell quoting: words are separated by
+ * whitespace, single quotes are literal, inside double quotes a backslash only
+ * escapes $ ` " \ and newline, and outside quotes it escapes any character.
+ * Backslash-newline is a line continuation. Quotes and escapes are removed by
+ * compacting each word towards its start, so a word never grows and never
+ * overtakes the bytes still to be read; callers write the terminator at the
+ * returned end. A quote still open at the end of the text is an error, which
+ * every caller reports rather than taking the rest of the text as a value.
+ */
+typedef enum {
+    WORD_END,      // no words left
+    WORD_FOUND,    // *word .. *word_end holds the next word
+    WORD_UNCLOSED, // the text ended inside a quote
+} word_result_t;
+
+static word_result_t next_word(char **cursor, char *end, char **word, char **word_end) {
+    char *r = *cursor;
+    for (;;) {
+        while (r < end && is_space(*r)) r++;
+        if (r == end) {
+            *cursor = r;
+            return WORD_END;
+        }
+
+        char *w = r, quote = 0;
+        bool found = false;  // quotes alone make an (empty) word
+        *word = r;
+        while (r < end) {
+            char c = *r++;
+            if (quote == '\'') {
+                if (c == '\'') {
+                    quote = 0;
+                    continue;
+                }
+            } else if (quote == '"') {
+                if (c == '"') {
+                    quote = 0;
+                    continue;
+                }
+                if (c == '\\' && r < end && (*r == '$' || *r == '`' || *r == '"' || *r == '\\' || *r == '\n')) {
+                    c = *r++;
+                    if (c == '\n') continue;
+                }
+            } else if (is_space(c)) {
+                break;
+            } else if (c == '\'' || c == '"') {
+                quote = c;
+                found = true;
+                continue;
+            } else if (c == '\\' && r < end) {
+                c = *r++;
+                if (c == '\n') continue;
+            }
+            *w++ = c;
+            found = true;
+        }
+        if (quote) {
+            *cursor = r;
+            return WORD_UNCLOSED;
+        }
+        if (found) {
+            *word_end = w;
+            *cursor = r;
+            return WORD_FOUND;
+        }
+    }
+}
+
+/*
+ * Parse state
+ *
+ * parses, pmargp_feed and pmargp_parse_string keep their state on the parser
+ * and write through each argument's value_ptr. pmargp_parse_context keeps it
+ * in a pmargp_context_t instead and only reads the frozen parser, so any
+ * number of contexts can parse against one parser at the same time.
+ */
+typedef struct parse_state_t {
+    struct pmargp_parser_t *parser;     // only read when context is set
+    pmargp_context_t *context;          // NULL when parsing into the parser
+    pmargp_arena_t *arena;              // value copies and expanded argv
+    struct pmargp_mapping_t **mappings; // response files
+    int *pending;                       // argument waiting for its value
+    pmargp_source_t source;             // recorded with every value stored
+    int *operands;                      // operands seen so far
+    pmargp_span_t *remainder;           // operands past the positionals, NULL to drop them
+    pmargp_stats_t *stats;              // instrumentation, only touched with PMARGP_STATS
+    const struct parse_state_t *outer;  // parent's state inside a subcommand, NULL at the top
+} parse_state_t;
+
+static parse_state_t parser_state(struct pmargp_parser_t *parser) {
+    parse_state_t state = {parser, NULL, &parser->arena, &parser->mappings, &parser->pending,
+                           PMARGP_SOURCE_ARGV, &parser->operands, parser->remainder, &parser->stats, NULL};
+    return state;
+}
+
+static parse_state_t context_state(pmargp_context_t *context) {
+    parse_state_t state = {(struct pmargp_parser_t *)context->parser, context, &context->arena,
+                           &context->mappings, &context->pending, PMARGP_SOURCE_ARGV,
+                           &context->operands, context->parser->remainder ? &context->remainder : NULL,
+                           &context->stats, NULL};
+    return state;
+}
+
+static inline bool bit_test(const uint64_t *bits, int idx) {
+    return (bits[idx / 64] >> (idx % 64)) & 1;
+}
+
+static inline void bit_set(uint64_t *bits, int idx) {
+    bits[idx / 64] |= (uint64_t)1 << (idx % 64);
+}
+
+static inline bool is_present(const parse_state_t *state, int idx) {
+    return state->context ? bit_test(state->context->present, idx) : state->parser->args[idx].allocated;
+}
+
+static inline void set_present(const parse_state_t *state, int idx) {
+    if (state->context) {
+        bit_set(state->context->present, idx);
+        state->context->sources[idx] = (unsigned char)state->source;
+    } else {
+        state->parser->args[idx].allocated = true;
+        state->parser->args[idx].source = state->source;
+    }
+}
+
+/*
+ * Response files
+ *
+ * An "@path" token is replaced by the words stored in path. The file is
+ * mapped privately and split in place by next_word, so every token points
+ * into the mapping. Only a token running into the very end of the file, with
+ * no byte left for its terminator, is copied into the arena. A path that
+ * cannot be opened leaves the token as it is, like GCC does, so values such
+ * as "@handle" still parse. Mappings are chained on the parse state. A
+ * parser keeps its values across parses, so a mapping that one of them
+ * points into is pinned and lives until free_parser; the next parse unmaps
+ * the rest. Each argument pins at most one mapping, so the chain stays
+ * bounded. Contexts drop their values on every reset and unmap everything
+ * in pmargp_context_reset.
+ */
+struct pmargp_mapping_t {
+    struct pmargp_mapping_t *next;
+    void *data;
+    size_t size;
+    bool pinned;  // a parser value points into it
+};
+
+// Nodes come from the allocator rather than the arena, so that releasing
+// them at the start of every parse does not leave the arena growing.
+static void unmap_all(const pmargp_allocator_t *allocator, struct pmargp_mapping_t **mappings) {
+    struct pmargp_mapping_t *mapping = *mappings;
+    while (mapping) {
+        struct pmargp_mapping_t *next = mapping->next;
+        unmap_path(mapping->data, mapping->size);
+        if (allocator->free) allocator->free(allocator->ctx, mapping);
+        mapping = next;
+    }
+    *mappings = NULL;
+}
+
+// Unmap what no stored value points into, keeping the pinned mappings chained
+static void unmap_unpinned(const pmargp_allocator_t *allocator, struct pmargp_mapping_t **mappings) {
+    struct pmargp_mapping_t **link = mappings;
+    while (*link) {
+        struct pmargp_mapping_t *mapping = *link;
+        if (mapping->pinned) {
+            link = &mapping->next;
+            continue;
+        }
+        *link = mapping->next;
+        unmap_path(mapping->data, mapping->size);
+        if (allocator->free) allocator->free(allocator->ctx, mapping);
+    }
+}
+
+typedef struct {
+    char **items;
+    size_t count;
+    size_t capacity;
+} token_list_t;
+
+static int push_token(pmargp_arena_t *arena, token_list_t *list, char *token) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity ? list->capacity * 2 : 64;
+        char **items = arena_grow(arena, list->items, list->capacity * sizeof(char *), capacity * sizeof(char *));
+        if (!items) return PMARGP_ERR_MEMORY_ALLOCATION;
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = token;
+    return PMARGP_SUCCESS;
+}
+
+static int expand_token(const parse_state_t *state, token_list_t *list, char *token, int depth);
+
+// Map path privately for in-place tokenizing and chain the mapping on the
+// parse state. An empty file leaves *data NULL.
+static int attach_mapping(const parse_state_t *state, const char *path, char **data, size_t *size) {
+    void *mapped;
+    if (map_path(path, true, &mapped, size) != PMARGP_SUCCESS) return PMARGP_ERR_FILE_OPEN;
+    *data = mapped;
+    if (!mapped) return PMARGP_SUCCESS;
+
+    const pmargp_allocator_t *allocator = &state->arena->allocator;
+    struct pmargp_mapping_t *mapping = allocator->alloc(allocator->ctx, sizeof(*mapping));
+    if (!mapping) {
+        unmap_path(mapped, *size);
+        return PMARGP_ERR_MEMORY_ALLOCATION;
+    }
+    mapping->data = mapped;
+    mapping->size = *size;
+    mapping->pinned = false;
+    mapping->next = *state->mappings;
+    *state->mappings = mapping;
+    return PMARGP_SUCCESS;
+}
+
+static int expand_response_file(const parse_state_t *state, token_list_t *list, char *at, int depth) {
+    char *data;
+    size_t size;
+    int error = attach_mapping(state, at + 1, &data, &size);
+    if (error == PMARGP_ERR_FILE_OPEN) return push_token(state->arena, list, at);
+    if (error != PMARGP_SUCCESS || !data) return error;
+
+    char *cursor = data, *end = cursor + size, *token, *token_end;
+    word_result_t word;
+    while ((word = next_word(&cursor, end, &token, &token_end)) == WORD_FOUND) {
+        if (token_end < end) {
+            *token_end = '\0';
+        } else if (!(token = arena_strndup(state->arena, token, (size_t)(token_end - token)))) {
+            return PMARGP_ERR_MEMORY_ALLOCATION;
+        }
+        error = expand_token(state, list, token, depth);
+        if (error != PMARGP_SUCCESS) return error;
+    }
+    if (word == WORD_UNCLOSED) {
+        fprintf(stderr, "Unterminated quote in response file: %s\n", at + 1);
+        return PMARGP_ERR_INVALID_VALUE;
+    }
+    return PMARGP_SUCCESS;
+}
+
+static int expand_token(const parse_state_t *state, token_list_t *list, char *token, int depth) {
+    if (token[0] != '@' || token[1] == '\0') return push_token(state->arena, list, token);
+    if (depth >= PMARGP_MAX_RESPONSE_DEPTH) {
+        fprintf(stderr, "Response files nested too deeply: %s\n", token + 1);
+        return PMARGP_ERR_RESPONSE_DEPTH;
+    }
+    return expand_response_file(state, list, token, depth + 1);
+}
+
+static int expand_list(const parse_state_t *state, token_list_t *list, int argc, char **argv, int first) {
+    for (int i = 0; i < argc; i++) {
+        int error = i < first ? push_token(state->arena, list, argv[i]) : expand_token(state, list, argv[i], 0);
+        if (error != PMARGP_SUCCESS) return error;
+    }
+    if (list->count > INT_MAX || push_token(state->arena, list, NULL) != PMARGP_SUCCESS) {
+        return PMARGP_ERR_MEMORY_ALLOCATION;
+    }
+    return PMARGP_SUCCESS;
+}
+
+// Replace argc/argv with the expansion of every @file token. Without any,
+// argv is used as is and nothing is allocated. The parser keeps the array
+// for the next parse, so repeated parses only grow it past its largest size.
+static int expand_arguments(const parse_state_t *state, int *argc, char ***argv) {
+    int first = 1;
+    while (first < *argc && !((*argv)[first][0] == '@' && (*argv)[first][1] != '\0')) first++;
+    if (first == *argc) return PMARGP_SUCCESS;
+
+    struct pmargp_parser_t *parser = state->parser;
+    token_list_t list = {NULL, 0, 0};
+    if (!state->context) {
+        list.items = parser->expansion;
+        list.capacity = parser->expansion_capacity;
+    }
+    int error = expand_list(state, &list, *argc, *argv, first);
+    if (!state->context) {
+        parser->expansion = list.items;
+        parser->expansion_capacity = list.capacity;
+    }
+    if (error != PMARGP_SUCCESS) return error;
+    *argc = (int)list.count - 1;
+    *argv = list.items;
+    return PMARGP_SUCCESS;
+}
+
+// Pin the mapping a parser value points into, searching the commands' outer
+// parsers too since their response files and config live on the root.
+static void pin_mapping(const parse_state_t *state, const char *text) {
+    uintptr_t at = (uintptr_t)text;
+    for (const parse_state_t *owner = state; owner; owner = owner->outer) {
+        for (struct pmargp_mapping_t *mapping = *owner->mappings; mapping; mapping = mapping->next) {
+            uintptr_t start = (uintptr_t)mapping->data;
+            if (at >= start && at < start + mapping->size) {
+                mapping->pinned = true;
+                return;
+            }
+        }
+    }
+}
+
+// Convert and store one value token. Stable tokens are terminated and live
+// as long as the parse (argv, response files), so strings and paths may point
+// at them; anything else is copied into the arena first.
+static int store_value(const parse_state_t *state, int idx, const char *value, size_t len, bool stable) {
+    const pmargp_argument_t *arg = &state->parser->args[idx];
+    void *dest = state->context ? (void *)&state->context->values[idx] : arg->value_ptr;
+    const char *text = value;
+    bool needs_text = arg->type == PMARGP_STRING || arg->type == PMARGP_MMAP_FILE ||
+                      (arg->type >= PMARGP_R_FILE && arg->type <= PMARGP_B_RW_FILE);
+    if (needs_text && !stable && !(text = arena_strndup(state->arena, value, len))) {
+        return PMARGP_ERR_MEMORY_ALLOCATION;
+    }
+
+    switch (arg->type) {
+        case PMARGP_BOOL:
+            if (parse_bool(value, len, (bool*)dest) != PMARGP_SUCCESS) {
+                return PMARGP_ERR_INVALID_VALUE;
+            }
+            break;
+        case PMARGP_CHAR:
+            *(char*)dest = len ? value[0] : '\0';
+            break;
+        case PMARGP_STRING:
+            *(char**)dest = (char *)text;
+            break;
+        case PMARGP_FLOAT:
+            if (parse_float(value, len, (float*)dest) != PMARGP_SUCCESS) {
+                return PMARGP_ERR_INVALID_VALUE;
+            }
+            break;
+        case PMARGP_DOUBLE:
+            if (parse_double(value, len, (double*)dest) != PMARGP_SUCCESS) {
+                return PMARGP_ERR_INVALID_VALUE;
+            }
+            break;
+        case PMARGP_INT: {
+            int64_t number;
+            if (parse_signed(value, len, INT_MIN, INT_MAX, &number) != PMARGP_SUCCESS) {
+                return PMARGP_ERR_INVALID_VALUE;
+            }
+            *(int*)dest = (int)number;
+            break;
+        }
+        case PMARGP_INT64:
+            if (parse_signed(value, len, INT64_MIN, INT64_MAX, (int64_t*)dest) != PMARGP_SUCCESS) {
+                return PMARGP_ERR_INVALID_VALUE;
+            }
+            break;
+        case PMARGP_UINT64:
+            if (parse_unsigned(value, len, UINT64_MAX, (uint64_t*)dest) != PMARGP_SUCCESS) {
+                return PMARGP_ERR_INVALID_VALUE;
+            }
+            break;
+        case PMARGP_SIZE: {
+            uint64_t number;
+            if (parse_unsigned(value, len, SIZE_MAX, &number) != PMARGP_SUCCESS) {
+                return PMARGP_ERR_INVALID_VALUE;
+            }
+            *(size_t*)dest = (size_t)number;
+            break;
+        }
+        case PMARGP_R_FILE:
+        case PMARGP_W_FILE:
+        case PMARGP_RW_FILE:
+        case PMARGP_B_R_FILE:
+        case PMARGP_B_W_FILE:
+        case PMARGP_B_RW_FILE: {
+            if (!state->context && (arg->lazy || (state->parser->flags & PMARGP_FLAG_LAZY))) {
+                state->parser->args[idx].path = text;  // opened by pmargp_open_file
+                break;
+            }
+            if (!state->context && (state->parser->flags & PMARGP_FLAG_BATCH)) {
+                state->parser->args[idx].path = text;  // opened by open_batch
+                break;
+            }
+            const char *mode = get_file_mode(arg->type);
+            STAT_CLOCK(start);
+            FILE *file = fopen(text, mode);
+            STAT_ELAPSED(state->stats, file_open_ns, start);
+            STAT_ADD(state->stats, files_opened, 1);
+            if (file) {
+                *(FILE**)dest = file;
+            } else {
+                fprintf(stderr, "Error opening file: %s\n", text);
+                return PMARGP_ERR_FILE_OPEN;
+            }
+            break;
+        }
+        case PMARGP_MMAP_FILE: {
+            pmargp_mmap_t *view = dest;
+            if (!state->context && (state->parser->flags & PMARGP_FLAG_BATCH)) {
+                state->parser->args[idx].path = text;  // mapped by open_batch
+                break;
+            }
+            if (state->context) {
+                // the hints come from the view registered with the argument
+                view->advice = arg->value_ptr ? ((const pmargp_mmap_t*)arg->value_ptr)->advice : PMARGP_MADV_NORMAL;
+            }
+            STAT_CLOCK(start);
+            int mapped = map_file(text, view);
+            STAT_ELAPSED(state->stats, file_open_ns, start);
+            STAT_ADD(state->stats, files_opened, 1);
+            if (mapped != PMARGP_SUCCESS) {
+                fprintf(stderr, "Error opening file: %s\n", text);
+                return PMARGP_ERR_FILE_OPEN;
+            }
+            if (!state->context) state->parser->args[idx].owned = true;
+            break;
+        }
+        case PMARGP_INT_LIST:
+        case PMARGP_FLOAT_LIST:
+        case PMARGP_DOUBLE_LIST: {
+            pmargp_list_t *list = dest;
+            if (state->context) {
+                // the delimiter comes from the list registered with the argument
+                list->delimiter = arg->value_ptr ? ((const pmargp_list_t*)arg->value_ptr)->delimiter : '\0';
+            }
+            char delimiter = list->delimiter ? list->delimiter : ',';
+            size_t count = len ? count_delimiters(value, len, delimiter) + 1 : 0;
+            arena_mark_t mark = arena_mark(state->arena);
+            void *items = count ? arena_alloc(state->arena, count * list_element_size(arg->type)) : NULL;
+            if (count && !items) return PMARGP_ERR_MEMORY_ALLOCATION;
+            size_t failed;
+            if (count && convert_list(arg->type, value, len, delimiter, items, &failed) != PMARGP_SUCCESS) {
+                arena_rewind(state->arena, mark);
+                // a context's failed slot stays absent, so the position is kept on the context
+                if (state->context) {
+                    state->context->error_element = failed;
+                } else {
+                    list->error_element = failed;
+                }
+                fprintf(stderr, "Invalid element %zu of %s\n", failed,
+                        arg->key ? arg->key : arg->short_key ? arg->short_key : arg->name);
+                return PMARGP_ERR_INVALID_VALUE;
+            }
+            if (arg->type == PMARGP_INT_LIST) {
+                list->data.i = items;
+            } else if (arg->type == PMARGP_FLOAT_LIST) {
+                list->data.f = items;
+            } else {
+                list->data.d = items;
+            }
+            list->count = count;
+            break;
+        }
+        case PMARGP_CHOICE: {
+            const pmargp_choice_t *choice = arg->choices ? choice_find(arg->choices, value, len) : NULL;
+            if (!choice) {
+                fprintf(stderr, "Invalid choice %.*s for %s\n", (int)len, value,
+                        arg->key ? arg->key : arg->short_key ? arg->short_key : arg->name);
+                return PMARGP_ERR_INVALID_VALUE;
+            }
+            *(int*)dest = choice->value;
+            break;
+        }
+        default:
+            fprintf(stderr, "Unknown argument type for %s\n", arg->key);
+            return PMARGP_ERR_UNKNOWN_TYPE;
+    }
+    STAT_ADD(state->stats, conversions[arg->type], 1);
+    if (needs_text && stable && !state->context) pin_mapping(state, text);
+    set_present(state, idx);
+    return PMARGP_SUCCESS;
+}
+
+// store_value, recording in a context which argument and token failed
+static int store_layered(const parse_state_t *state, int idx, const char *value, size_t len, bool stable) {
+    int error = store_value(state, idx, value, len, stable);
+    if (error != PMARGP_SUCCESS && state->context) {
+        state->context->error_index = idx;
+        state->context->error_token = stable ? value : NULL;
+    }
+    return error;
+}
+
+// Resolve a long key no argument has exactly as the one key it abbreviates.
+// *idx stays -1 when nothing starts with it.
+static int match_abbreviation(const parse_state_t *state, const char *token, size_t len, bool stable, int *idx) {
+    const pmargp_index_t *index = &state->parser->index;
+    if (len <= 2 || token[0] != '-' || token[1] != '-' || index->sorted_argc != state->parser->argc) {
+        return PMARGP_SUCCESS;
+    }
+    size_t first;
+    size_t count = prefix_range(index, token, len, &first, STAT_COUNTER(state->stats, key_compares));
+    if (count == 1) *idx = index->sorted[first].index;
+    if (count <= 1) return PMARGP_SUCCESS;
+
+    fprintf(stderr, "Ambiguous option %.*s, could be:", (int)len, token);
+    for (size_t i = first; i < first + count; i++) fprintf(stderr, " %s", index->sorted[i].key);
+    fprintf(stderr, "\n");
+    if (state->context) {
+        state->context->error_index = -1;
+        state->context->error_token = stable ? token : NULL;
+    }
+    return PMARGP_ERR_AMBIGUOUS;
+}
+
+// pending after "--": every token left is an operand, never a key
+#define PENDING_END_OF_OPTIONS (-2)
+// pending after a repeated option: its value is skipped
+#define PENDING_SKIP_VALUE (-3)
+
+static int set_flag(const parse_state_t *state, int idx) {
+    if (is_present(state, idx)) return PMARGP_SUCCESS;
+    void *dest = state->context ? (void *)&state->context->values[idx] : state->parser->args[idx].value_ptr;
+    *(bool*)dest = true;
+    STAT_ADD(state->stats, conversions[PMARGP_BOOL], 1);
+    set_present(state, idx);
+    return PMARGP_SUCCESS;
+}
+
+// An option whose value is attached to its token ("--key=value", "-ovalue")
+// or, when value is NULL, follows as the next token. The first occurrence of
+// an argument wins and repeats are skipped along with their values.
+static int take_option(const parse_state_t *state, int idx, const char *value, size_t value_len, bool stable) {
+    if (state->parser->args[idx].type == PMARGP_BOOL && !value) return set_flag(state, idx);
+    if (!value) {
+        *state->pending = is_present(state, idx) ? PENDING_SKIP_VALUE : idx;
+        return PMARGP_SUCCESS;
+    }
+    if (is_present(state, idx)) return PMARGP_SUCCESS;
+    return store_layered(state, idx, value, value_len, stable);
+}
+
+static int unknown_option(const parse_state_t *state, const char *token, size_t len, bool stable) {
+    fprintf(stderr, "Unknown option: %.*s\n", (int)len, token);
+    if (state->context) {
+        state->context->error_index = -1;
+        state->context->error_token = stable ? token : NULL;
+    }
+    return PMARGP_ERR_INVALID_KEY;
+}
+
+// Short key lookup, inside a subcommand falling back to each parent in
+// turn. *owner is set to the state of the parser that has the key.
+static int find_short(const parse_state_t **owner, char letter) {
+    int slot = letter_slot(letter);
+    for (const parse_state_t *state = *owner; state; state = state->outer) {
+        STAT_ADD(state->stats, lookups, 1);
+        int idx = slot < 0 ? -1 : state->parser->index.shorts[slot] - 1;
+        if (idx >= 0) {
+            *owner = state;
+            return idx;
+        }
+    }
+    return -1;
+}
+
+// "-abc": every letter but the last must be a boolean flag. The first letter
+// that takes a value takes the rest of the token as its value ("-ofile"), or
+// the next token when it is the last letter.
+static int lex_short_cluster(const parse_state_t *state, const char *token, size_t len, bool stable) {
+    for (size_t i = 1; i < len; i++) {
+        const parse_state_t *owner = state;
+        int idx = find_short(&owner, token[i]);
+        if (idx < 0) return token[i] == 'h' ? PMARGP_HELP_REQUESTED : unknown_option(state, token, len, stable);
+        if (owner->parser->args[idx].type != PMARGP_BOOL) {
+            bool attached = i + 1 < len;
+            return take_option(owner, idx, attached ? token + i + 1 : NULL, len - i - 1, stable);
+        }
+        set_flag(owner, idx);
+    }
+    return PMARGP_SUCCESS;
+}
+
+static const pmargp_command_t *find_command(const struct pmargp_parser_t *parser, const char *name, size_t len) {
+    for (int i = 0; i < parser->command_count; i++) {
+        const char *candidate = parser->commands[i].name;
+        if (strncmp(candidate, name, len) == 0 && candidate[len] == '\0') return &parser->commands[i];
+    }
+    return NULL;
+}
+
+static void release_command(struct pmargp_parser_t *parser) {
+    struct pmargp_parser_t *child = parser->selected;
+    if (!child) return;
+    free_parser(child);
+    if (parser->arena.allocator.free) parser->arena.allocator.free(parser->arena.allocator.ctx, child);
+    parser->selected = NULL;
+}
+
+// Build the parser of the command named by the operand in command position.
+// It lives until the next parse, with the parent's allocator.
+static int select_command(const parse_state_t *state, const char *token, size_t len, bool stable) {
+    struct pmargp_parser_t *parser = state->parser;
+    const pmargp_command_t *command = find_command(parser, token, len);
+    if (!command || state->context) {
+        if (command) {
+            fprintf(stderr, "Command %s cannot be built by a context\n", command->name);
+        } else {
+            fprintf(stderr, "Unknown command: %.*s\n", (int)len, token);
+        }
+        if (state->context) {
+            state->context->error_index = -1;
+            state->context->error_token = stable ? token : NULL;
+        }
+        return command ? PMARGP_ERR_FROZEN : PMARGP_ERR_UNKNOWN_COMMAND;
+    }
+
+    const pmargp_allocator_t *allocator = &parser->arena.allocator;
+    struct pmargp_parser_t *child = allocator->alloc(allocator->ctx, sizeof(*child));
+    if (!child) return PMARGP_ERR_MEMORY_ALLOCATION;
+    parser_start_with_allocator(child, allocator);
+    parser->selected = child;
+
+    // "program command", for the usage line of the command's help
+    size_t prefix = parser->name ? strlen(parser->name) + 1 : 0;
+    char *name = arena_alloc(&child->arena, prefix + len + 1);
+    if (!name) return PMARGP_ERR_MEMORY_ALLOCATION;
+    if (prefix) {
+        memcpy(name, parser->name, prefix - 1);
+        name[prefix - 1] = ' ';
+    }
+    memcpy(name + prefix, token, len);
+    name[prefix + len] = '\0';
+    child->name = name;
+    child->description = command->description;
+    child->flags = parser->flags;
+    child->open_workers = parser->open_workers;
+    child->parent = parser;
+
+    int error = command->build(child, command->data);
+    STAT_ADD(state->stats, registration_ns, child->stats.registration_ns);
+    if (error != PMARGP_SUCCESS) return error;
+    if ((child->flags & PMARGP_FLAG_ABBREV) && prefix_index_build(child) != PMARGP_SUCCESS) {
+        return PMARGP_ERR_MEMORY_ALLOCATION;
+    }
+    if (child->remainder) memset(child->remainder, 0, sizeof(*child->remainder));
+    return PMARGP_SUCCESS;
+}
+
+// State of the selected command's parser, linked back to its parent's
+static parse_state_t command_state(const parse_state_t *state) {
+    parse_state_t inner = parser_state(state->parser->selected);
+    inner.stats = state->stats;
+    inner.outer = state;
+    return inner;
+}
+
+// The next operand fills the next positional argument, then goes to the
+// remainder. While the operands sit next to each other in argv the
+// remainder is a view of argv; the first one out of line moves the pointers
+// gathered so far into an array in the arena.
+static int take_operand(const parse_state_t *state, const char *token, size_t len, bool stable, char **slot) {
+    int position = (*state->operands)++;
+    if (position < state->parser->positional_count) {
+        return store_layered(state, state->parser->positionals[position], token, len, stable);
+    }
+    if (position == state->parser->positional_count && state->parser->command_count &&
+        *state->pending != PENDING_END_OF_OPTIONS) {
+        return select_command(state, token, len, stable);
+    }
+    pmargp_span_t *rest = state->remainder;
+    if (!rest) return PMARGP_SUCCESS;
+    if (slot && rest->capacity == 0 && (rest->count == 0 || rest->items + rest->count == slot)) {
+        if (rest->count == 0) rest->items = slot;
+        rest->count++;
+        return PMARGP_SUCCESS;
+    }
+
+    char *text = (char *)token;
+    if (!stable && !(text = arena_strndup(state->arena, token, len))) return PMARGP_ERR_MEMORY_ALLOCATION;
+    if (rest->count == rest->capacity || rest->capacity == 0) {
+        int capacity = rest->capacity ? rest->capacity * 2 : 16;
+        while (capacity <= rest->count) capacity *= 2;
+        char **items = arena_grow(state->arena, rest->capacity ? rest->items : NULL,
+                                  (size_t)rest->capacity * sizeof(char *), (size_t)capacity * sizeof(char *));
+        if (!items) return PMARGP_ERR_MEMORY_ALLOCATION;
+        if (rest->capacity == 0 && rest->count) memcpy(items, rest->items, (size_t)rest->count * sizeof(char *));
+        rest->items = items;
+        rest->capacity = capacity;
+    }
+    rest->items[rest->count++] = text;
+    return PMARGP_SUCCESS;
+}
+
+// One step of the argv lexer. Each token is classified once, by its first
+// bytes: the value a previous option is waiting for, the "--" terminator, a
+// long option (optionally "--key=value", split by length without copying),
+// a short option or cluster of short options, or an operand. Option tokens
+// cost exactly one table lookup, and a key nothing matches is an error.
+// Short keys are letters, so "-5" and "-" are operands. slot is where the
+// token sits in argv, NULL when it does not come from an argv array.
+// Returns PMARGP_HELP_REQUESTED for "--help" or "-h" in option position.
+// Once a command is selected its parser gets every token, except the value
+// a parent option is still waiting for. Keys the command does not have are
+// looked up in its parents.
+static int feed_token(const parse_state_t *state, const char *token, size_t len, bool stable, char **slot) {
+    int pending = *state->pending;
+    if (pending == -1 && state->parser->selected) {
+        parse_state_t inner = command_state(state);
+        return feed_token(&inner, token, len, stable, slot);
+    }
+    STAT_ADD(state->stats, tokens, 1);
+    if (pending == PENDING_END_OF_OPTIONS) return take_operand(state, token, len, stable, slot);
+    if (pending != -1) {
+        *state->pending = -1;
+        return pending >= 0 ? store_layered(state, pending, token, len, stable) : PMARGP_SUCCESS;
+    }
+    if (len < 2 || token[0] != '-' || (token[1] >= '0' && token[1] <= '9') || token[1] == '.') {
+        return take_operand(state, token, len, stable, slot);
+    }
+
+    if (token[1] != '-') {
+        if (len > 2) return lex_short_cluster(state, token, len, stable);
+        if (token[1] == 'h') return PMARGP_HELP_REQUESTED;
+        const parse_state_t *owner = state;
+        int idx = find_short(&owner, token[1]);
+        return idx < 0 ? unknown_option(state, token, len, stable) : take_option(owner, idx, NULL, 0, stable);
+    }
+
+    if (len == 2) {
+        *state->pending = PENDING_END_OF_OPTIONS;
+        return PMARGP_SUCCESS;
+    }
+    const char *equals = memchr(token + 2, '=', len - 2);
+    size_t key_len = equals ? (size_t)(equals - token) : len;
+    if (!equals && is_help_token(token, len)) return PMARGP_HELP_REQUESTED;
+
+    for (const parse_state_t *owner = state; owner; owner = owner->outer) {
+        STAT_ADD(owner->stats, lookups, 1);
+        int idx = index_find_long(owner->parser, token, key_len, STAT_COUNTER(owner->stats, key_compares));
+        if (idx == -1 && (owner->parser->flags & PMARGP_FLAG_ABBREV)) {
+            int error = match_abbreviation(owner, token, key_len, stable, &idx);
+            if (error != PMARGP_SUCCESS) return error;
+        }
+        if (idx != -1) {
+            return take_option(owner, idx, equals ? equals + 1 : NULL, equals ? len - key_len - 1 : 0, stable);
+        }
+    }
+    return unknown_option(state, token, len, stable);
+}
+
+// Feed argv[1..argc) through the lexer. After an error the rest of argv is
+// still checked for help, which takes precedence over any error.
+static int lex_argv(const parse_state_t *state, int argc, char *argv[]) {
+    int error = PMARGP_SUCCESS;
+    for (int i = 1; i < argc; i++) {
+        const char *token = argv[i];
+        size_t len = strlen(token);
+        if (error == PMARGP_SUCCESS) {
+            error = feed_token(state, token, len, true, &argv[i]);
+            if (error == PMARGP_HELP_REQUESTED) return error;
+        } else if (len == 2 && token[0] == '-' && token[1] == '-') {
+            break;
+        } else if (is_help_token(token, len)) {
+            return PMARGP_HELP_REQUESTED;
+        }
+    }
+    return error;
+}
+
+/*
+ * Layered sources
+ *
+ * The command line is parsed first, then the environment and the config
+ * file fill in what is still absent. Since a value is never stored twice,
+ * this single ordered pass is the whole precedence merge: argv over the
+ * environment over the config file over the defaults.
+ */
+// Only the bound arguments are visited, so a parser without any bindings
+// pays nothing here however many options it has.
+static int merge_environment(const parse_state_t *state) {
+    for (int j = 0; j < state->parser->env_count; j++) {
+        int i = state->parser->env_args[j];
+        const char *name = state->parser->args[i].env;
+        const char *value;
+        if (is_present(state, i) || !(value = getenv(name))) continue;
+        // setenv may free the string later, so it is copied like a fed token
+        int error = store_layered(state, i, value, strlen(value), false);
+        if (error != PMARGP_SUCCESS) return error;
+    }
+    return PMARGP_SUCCESS;
+}
+
+static inline bool is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Argument a config key names: a key as registered, or a long key without
+// its leading "--".
+static int find_config_key(const struct pmargp_parser_t *parser, const char *key, size_t len) {
+    if (key[0] == '-') return find_argument(parser, key, len);
+    char dashed[256];
+    if (len + 2 > sizeof(dashed)) return -1;
+    dashed[0] = dashed[1] = '-';
+    memcpy(dashed + 2, key, len);
+    return find_argument(parser, dashed, len + 2);
+}
+
+// Values point into the file's mapping, which store_value pins like a
+// response file's, so they stay valid until free_parser.
+static int merge_config(const parse_state_t *state, const char *path) {
+    char *data;
+    size_t size;
+    int error = attach_mapping(state, path, &data, &size);
+    if (error == PMARGP_ERR_FILE_OPEN) fprintf(stderr, "Error opening config file: %s\n", path);
+    if (error != PMARGP_SUCCESS || !data) return error;
+
+    char *end = data + size;
+    for (char *line = data; line < end;) {
+        char *line_end = memchr(line, '\n', (size_t)(end - line));
+        if (!line_end) line_end = end;
+        char *next = line_end < end ? line_end + 1 : end;
+
+        char *key = line;
+        while (key < line_end && is_blank(*key)) key++;
+        char *equals = key < line_end && *key != '#' && *key != ';' ? memchr(key, '=', (size_t)(line_end - key)) : NULL;
+        if (!equals) {
+            line = next;
+            continue;
+        }
+        char *key_end = equals;
+        while (key_end > key && is_blank(key_end[-1])) key_end--;
+        int idx = key_end > key ? find_config_key(state->parser, key, (size_t)(key_end - key)) : -1;
+        if (idx < 0 || is_present(state, idx)) {
+            line = next;
+            continue;
+        }
+
+        char *value = equals + 1, *value_end = line_end;
+        while (value < value_end && is_blank(*value)) value++;
+        while (value_end > value && is_blank(value_end[-1])) value_end--;
+        if (value < value_end && (*value == '\'' || *value == '"')) {
+            // quoted values are unquoted in place by the shell tokenizer
+            char *cursor = value, *word, *word_end;
+            word_result_t found = next_word(&cursor, value_end, &word, &word_end);
+            if (found == WORD_UNCLOSED) {
+                fprintf(stderr, "Unterminated quote in config file: %s\n", path);
+                return PMARGP_ERR_INVALID_VALUE;
+            }
+            if (found == WORD_FOUND) {
+                value = word;
+                value_end = word_end;
+            }
+        }
+        bool stable = value_end < end;
+        if (stable) *value_end = '\0';
+        error = store_layered(state, idx, value, (size_t)(value_end - value), stable);
+        if (error != PMARGP_SUCCESS) return error;
+        line = next;
+    }
+    return PMARGP_SUCCESS;
+}
+
+/*
+ * Batched opening
+ *
+ * Under PMARGP_FLAG_BATCH the lexer only records the path of each file
+ * argument. Once the whole command line is read, open_batch hands the paths
+ * to a few threads that claim jobs from a shared cursor, each writing only
+ * its own job. The results are stored in argument order after every thread
+ * has joined, so the outcome does not depend on which open finished first.
+ * If any open fails nothing is stored: every failure is printed and what
+ * did open is closed again.
+ */
+static inline bool is_file_type(pmargp_type_t type) {
+    return type >= PMARGP_R_FILE && type <= PMARGP_B_RW_FILE;
+}
+
+// A path recorded by the lexer that open_batch has not opened yet
+static bool is_batched(const struct pmargp_parser_t *parser, const pmargp_argument_t *arg) {
+    if (!arg->path) return false;
+    if (arg->type == PMARGP_MMAP_FILE) return !arg->owned;
+    return is_file_type(arg->type) && !arg->lazy && !(parser->flags & PMARGP_FLAG_LAZY);
+}
+
+typedef struct {
+    pmargp_argument_t *arg;
+    FILE *file;
+    pmargp_mmap_t view;
+    int error;
+} open_job_t;
+
+typedef struct {
+    open_job_t *jobs;
+    size_t count;
+    size_t next;     // first job nobody has claimed
+    bool threaded;   // lock is initialised
+#ifdef PMARGP_HAVE_THREADS
+    pthread_mutex_t lock;
+#endif
+} open_batch_t;
+
+static open_job_t *claim_job(open_batch_t *batch) {
+#ifdef PMARGP_HAVE_THREADS
+    if (batch->threaded) pthread_mutex_lock(&batch->lock);
+#endif
+    open_job_t *job = batch->next < batch->count ? &batch->jobs[batch->next++] : NULL;
+#ifdef PMARGP_HAVE_THREADS
+    if (batch->threaded) pthread_mutex_unlock(&batch->lock);
+#endif
+    return job;
+}
+
+static void *open_worker(void *data) {
+    open_batch_t *batch = data;
+    open_job_t *job;
+    while ((job = claim_job(batch)) != NULL) {
+        if (job->arg->type == PMARGP_MMAP_FILE) {
+            job->error = map_file(job->arg->path, &job->view);
+        } else {
+            job->file = fopen(job->arg->path, get_file_mode(job->arg->type));
+            job->error = job->file ? PMARGP_SUCCESS : PMARGP_ERR_FILE_OPEN;
+        }
+    }
+    return NULL;
+}
+
+// The calling thread works too, so `workers` threads means workers - 1 new
+// ones. Threads that cannot be created just leave more jobs to the others.
+static void run_batch(open_batch_t *batch, pmargp_arena_t *arena, int workers) {
+#ifdef PMARGP_HAVE_THREADS
+    size_t extra = workers > 1 ? (size_t)workers - 1 : 0;
+    if (extra > batch->count - 1) extra = batch->count - 1;
+    pthread_t *threads = extra ? arena_alloc(arena, extra * sizeof(pthread_t)) : NULL;
+    size_t started = 0;
+    if (threads && pthread_mutex_init(&batch->lock, NULL) == 0) {
+        batch->threaded = true;
+        while (started < extra && pthread_create(&threads[started], NULL, open_worker, batch) == 0) started++;
+    }
+    open_worker(batch);
+    for (size_t i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    if (batch->threaded) pthread_mutex_destroy(&batch->lock);
+#else
+    (void)arena;
+    (void)workers;
+    open_worker(batch);
+#endif
+}
+
+// One batch per parse, over the parser and the commands it selected
+static int open_batch(const parse_state_t *state) {
+    struct pmargp_parser_t *root = state->parser;
+    int flags = 0;
+    for (struct pmargp_parser_t *p = root; p; p = p->selected) flags |= p->flags;
+    if (!(flags & PMARGP_FLAG_BATCH)) return PMARGP_SUCCESS;
+
+    size_t count = 0;
+    for (struct pmargp_parser_t *p = root; p; p = p->selected) {
+        for (int i = 0; i < p->argc; i++) count += is_batched(p, &p->args[i]);
+    }
+    if (count == 0) return PMARGP_SUCCESS;
+
+    arena_mark_t mark = arena_mark(&root->arena);
+    open_job_t *jobs = arena_alloc(&root->arena, count * sizeof(open_job_t));
+    if (!jobs) return PMARGP_ERR_MEMORY_ALLOCATION;
+    size_t n = 0;
+    for (struct pmargp_parser_t *p = root; p; p = p->selected) {
+        for (int i = 0; i < p->argc; i++) {
+            pmargp_argument_t *arg = &p->args[i];
+            if (!is_batched(p, arg)) continue;
+            open_job_t *job = &jobs[n++];
+            memset(job, 0, sizeof(*job));
+            job->arg = arg;
+            if (arg->type == PMARGP_MMAP_FILE) job->view.advice = ((const pmargp_mmap_t*)arg->value_ptr)->advice;
+        }
+    }
+
+    open_batch_t batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.jobs = jobs;
+    batch.count = count;
+    STAT_CLOCK(start);
+    run_batch(&batch, &root->arena, root->open_workers > 0 ? root->open_workers : PMARGP_OPEN_WORKERS);
+    STAT_ELAPSED(state->stats, file_open_ns, start);
+    STAT_ADD(state->stats, files_opened, count);
+
+    int error = PMARGP_SUCCESS;
+    for (size_t j = 0; j < count; j++) {
+        if (jobs[j].error == PMARGP_SUCCESS) continue;
+        fprintf(stderr, "Error opening file: %s\n", jobs[j].arg->path);
+        error = PMARGP_ERR_FILE_OPEN;
+    }
+    for (size_t j = 0; j < count; j++) {
+        open_job_t *job = &jobs[j];
+        pmargp_argument_t *arg = job->arg;
+        arg->path = NULL;
+        if (error != PMARGP_SUCCESS) {
+            if (job->file) fclose(job->file);
+            if (arg->type == PMARGP_MMAP_FILE && job->error == PMARGP_SUCCESS) unmap_file(&job->view);
+        } else if (arg->type == PMARGP_MMAP_FILE) {
+            *(pmargp_mmap_t*)arg->value_ptr = job->view;
+            arg->owned = true;
+        } else {
+            *(FILE**)arg->value_ptr = job->file;
+        }
+    }
+    arena_rewind(&root->arena, mark);
+    return error;
+}
+
+static int check_required(const parse_state_t *state) {
+    const struct pmargp_parser_t *parser = state->parser;
+
+    if (state->context) {
+        // whole words at a time against the bitset built by pmargp_freeze
+        for (int w = 0; w < (parser->argc + 63) / 64; w++) {
+            uint64_t missing = parser->required[w] & ~state->context->present[w];
+            if (missing) {
+                state->context->error_index = w * 64 + trailing_zeroes(missing);
+                return PMARGP_ERR_ARG_MISSING;
+            }
+        }
+        return PMARGP_SUCCESS;
+    }
+
+    for (int j = 0; j < parser->required_count; j++) {
+        if (!parser->args[parser->required_args[j]].allocated) {
+            return PMARGP_ERR_ARG_MISSING;
+        }
+    }
+    return PMARGP_SUCCESS;
+}
+
+// End of every parse: drop a dangling key, merge the lower-precedence
+// sources, then check that the required arguments arrived.
+static int finish_parse(const parse_state_t *state) {
+    STAT_CLOCK(start);
+    *state->pending = -1; // a key without its value is dropped
+    parse_state_t layer = *state;
+    layer.source = PMARGP_SOURCE_ENV;
+    int error = merge_environment(&layer);
+    if (error == PMARGP_SUCCESS && state->parser->config_path) {
+        layer.source = PMARGP_SOURCE_CONFIG;
+        error = merge_config(&layer, state->parser->config_path);
+    }
+    if (error == PMARGP_SUCCESS) error = check_required(state);
+    STAT_ELAPSED(state->stats, required_ns, start);
+    if (error == PMARGP_SUCCESS && state->parser->selected) {
+        parse_state_t inner = command_state(state);
+        error = finish_parse(&inner);
+    }
+    if (error == PMARGP_SUCCESS && !state->outer && !state->context) error = open_batch(state);
+    return error;
+}
+
+int pmargp_begin(struct pmargp_parser_t *parser) {
+    if (!parser) return PMARGP_ERR_NULL;
+    if (parser->argc == 0 && parser->command_count == 0) return PMARGP_ERR_NO_ARGUMENTS;
+    if (parser->frozen) return PMARGP_ERR_FROZEN;
+    release_command(parser);
+    unmap_unpinned(&parser->arena.allocator, &parser->mappings);
+    if (parser->flags & PMARGP_FLAG_BATCH) {
+        // paths left behind by a parse that failed before its batch
+        for (int i = 0; i < parser->argc; i++) {
+            if (is_batched(parser, &parser->args[i])) parser->args[i].path = NULL;
+        }
+    }
+    if ((parser->flags & PMARGP_FLAG_ABBREV) && prefix_index_build(parser) != PMARGP_SUCCESS) {
+        return PMARGP_ERR_MEMORY_ALLOCATION;
+    }
+    parser->pending = -1;
+    parser->operands = 0;
+    if (parser->remainder) memset(parser->remainder, 0, sizeof(*parser->remainder));
+    return PMARGP_SUCCESS;
+}
+
+int pmargp_feed(struct pmargp_parser_t *parser, const char *token, size_t len) {
+    if (!parser || (!token && len)) return PMARGP_ERR_NULL;
+    if (parser->frozen) return PMARGP_ERR_FROZEN;
+    parse_state_t state = parser_state(parser);
+    STAT_CLOCK(start);
+    int error = feed_token(&state, token, len, false, NULL);
+    STAT_ELAPSED(state.stats, lex_ns, start);
+    return error == PMARGP_HELP_REQUESTED ? handle_help(parser) : error;
+}
+
+int pmargp_finish(struct pmargp_parser_t *parser) {
+    if (!parser) return PMARGP_ERR_NULL;
+    parse_state_t state = parser_state(parser);
+    return finish_parse(&state);
+}
+
+int pmargp_parse_string(struct pmargp_parser_t *parser, char *buf, size_t len) {
+    if (!parser || (!buf && len)) return PMARGP_ERR_NULL;
+    int error = pmargp_begin(parser);
+    if (error != PMARGP_SUCCESS) return error;
+
+    parse_state_t state = parser_state(parser);
+    char *cursor = buf, *end = buf + len, *token, *token_end;
+    word_result_t word;
+    STAT_CLOCK(start);
+    while ((word = next_word(&cursor, end, &token, &token_end)) == WORD_FOUND) {
+        *token_end = '\0';  // buf[len] is writable, so this is in bounds
+        error = feed_token(&state, token, (size_t)(token_end - token), true, NULL);
+        if (error != PMARGP_SUCCESS) break;
+    }
+    STAT_ELAPSED(state.stats, lex_ns, start);
+    if (word == WORD_UNCLOSED) {
+        fprintf(stderr, "Unterminated quote in command string\n"); // buf is already rewritten
+        return PMARGP_ERR_INVALID_VALUE;
+    }
+    if (error == PMARGP_HELP_REQUESTED) return handle_help(parser);
+    if (error != PMARGP_SUCCESS) return error;
+    return finish_parse(&state);
+}
+
+int parses(struct pmargp_parser_t* parser, int argc, char* argv[]) {
+    int error = pmargp_begin(parser);
+    if (error != PMARGP_SUCCESS) return error;
+    parse_state_t state = parser_state(parser);
+    error = expand_arguments(&state, &argc, &argv);
+    if (error != PMARGP_SUCCESS) return error;
+    STAT_CLOCK(start);
+    error = lex_argv(&state, argc, argv);
+    STAT_ELAPSED(state.stats, lex_ns, start);
+    if (error == PMARGP_HELP_REQUESTED) return handle_help(parser);
+    if (error != PMARGP_SUCCESS) return error;
+    return finish_parse(&state);
+}
+
+static int open_deferred(struct pmargp_parser_t *parser, pmargp_argument_t *arg) {
+    STAT_CLOCK(start);
+    FILE *file = fopen(arg->path, get_file_mode(arg->type));
+    STAT_ELAPSED(&parser->stats, file_open_ns, start);
+    STAT_ADD(&parser->stats, files_opened, 1);
+    if (!file) {
+        fprintf(stderr, "Error opening file: %s\n", arg->path);
+        return PMARGP_ERR_FILE_OPEN;
+    }
+    *(FILE**)arg->value_ptr = file;
+    arg->owned = true;
+    return PMARGP_SUCCESS;
+}
+
+int pmargp_open_file(struct pmargp_parser_t *parser, const char *key, FILE **file) {
+    if (!parser || !key) return PMARGP_ERR_NULL;
+    pmargp_argument_t *arg = get_argument(parser, key);
+    if (!arg) return PMARGP_ERR_INVALID_KEY;
+    if (!is_file_type(arg->type)) return PMARGP_ERR_UNKNOWN_TYPE;
+
+    if (arg->path && !arg->owned) {
+        int error = open_deferred(parser, arg);
+        if (error != PMARGP_SUCCESS) return error;
+    }
+    if (file) *file = *(FILE**)arg->value_ptr;
+    return PMARGP_SUCCESS;
+}
+
+int pmargp_open_files(struct pmargp_parser_t *parser) {
+    if (!parser) return PMARGP_ERR_NULL;
+    for (int i = 0; i < parser->argc; i++) {
+        pmargp_argument_t *arg = &parser->args[i];
+        if (is_file_type(arg->type) && arg->path && !arg->owned) {
+            int error = open_deferred(parser, arg);
+            if (error != PMARGP_SUCCESS) return error;
+        }
+    }
+    return PMARGP_SUCCESS;
+}
+
+size_t pmargp_candidates(struct pmargp_parser_t *parser, const char *prefix,
+                         const pmargp_argument_t **out, size_t cap) {
+    if (!parser || !prefix) return 0;
+    if (!parser->frozen && prefix_index_build(parser) != PMARGP_SUCCESS) return 0;
+    size_t first;
+    size_t count = prefix_range(&parser->index, prefix, strlen(prefix), &first, NULL);
+    for (size_t i = 0; out && i < count && i < cap; i++) {
+        out[i] = &parser->args[parser->index.sorted[first + i].index];
+    }
+    return count;
+}
+
+int pmargp_freeze(struct pmargp_parser_t *parser) {
+    if (!parser) return PMARGP_ERR_NULL;
+    if (parser->frozen) return PMARGP_SUCCESS;
+    release_command(parser);  // contexts never delegate to a built command
+
+    size_t words = ((size_t)parser->argc + 63) / 64;
+    uint64_t *required = arena_alloc(&parser->arena, words ? words * sizeof(uint64_t) : 1);
+    if (!required) return PMARGP_ERR_MEMORY_ALLOCATION;
+    memset(required, 0, words * sizeof(uint64_t));
+    for (int i = 0; i < parser->argc; i++) {
+        if (parser->args[i].required) bit_set(required, i);
+    }
+    if (prefix_index_build(parser) != PMARGP_SUCCESS) return PMARGP_ERR_MEMORY_ALLOCATION;
+    parser->required = required;
+    parser->frozen = true;
+    return PMARGP_SUCCESS;
+}
+
+#ifdef PMARGP_STATS
+static size_t arena_bytes(const pmargp_arena_t *arena) {
+    size_t bytes = 0;
+    for (const struct pmargp_arena_block_t *block = arena->head; block; block = block->next) {
+        bytes += sizeof(*block) + block->size;
+    }
+    return bytes;
+}
+#endif
+
+static int copy_stats(const pmargp_stats_t *stats, const pmargp_arena_t *arena, pmargp_stats_t *out) {
+#ifdef PMARGP_STATS
+    *out = *stats;
+    out->arena_bytes = arena_bytes(arena);
+    return PMARGP_SUCCESS;
+#else
+    (void)stats;
+    (void)arena;
+    memset(out, 0, sizeof(*out));
+    return PMARGP_ERR_NO_STATS;
+#endif
+}
+
+int pmargp_stats(const struct pmargp_parser_t *parser, pmargp_stats_t *out) {
+    if (!parser || !out) return PMARGP_ERR_NULL;
+    return copy_stats(&parser->stats, &parser->arena, out);
+}
+
+int pmargp_context_init(pmargp_context_t *context, const struct pmargp_parser_t *parser) {
+    if (!context || !parser) return PMARGP_ERR_NULL;
+    memset(context, 0, sizeof(*context));
+    if (!parser->frozen) return PMARGP_ERR_NOT_FROZEN;
+
+    // values, the presence bitset and the sources share one allocation,
+    // widest first so that all of them stay aligned
+    size_t words = ((size_t)parser->argc + 63) / 64;
+    size_t size = (size_t)parser->argc * (sizeof(pmargp_value_t) + 1) + words * sizeof(uint64_t);
+    pmargp_value_t *values = NULL;
+    if (size) {
+        values = parser->arena.allocator.alloc(parser->arena.allocator.ctx, size);
+        if (!values) return PMARGP_ERR_MEMORY_ALLOCATION;
+    }
+    context->parser = parser;
+    context->values = values;
+    context->present = values ? (uint64_t *)(values + parser->argc) : NULL;
+    context->sources = values ? (unsigned char *)(context->present + words) : NULL;
+    context->arena.head = NULL;
+    context->arena.allocator = parser->arena.allocator;
+    context->mappings = NULL;
+    if (context->present) memset(context->present, 0, words * sizeof(uint64_t)); // nothing to release yet
+    pmargp_context_reset(context);
+    return PMARGP_SUCCESS;
+}
+
+void pmargp_context_reset(pmargp_context_t *context) {
+    if (!context || !context->parser) return;
+    const struct pmargp_parser_t *parser = context->parser;
+
+    // a word of the bitset at a time, visiting only the arguments that are present
+    for (int w = 0; context->present && w < (parser->argc + 63) / 64; w++) {
+        for (uint64_t bits = context->present[w]; bits; bits &= bits - 1) {
+            int i = w * 64 + trailing_zeroes(bits);
+            pmargp_type_t type = parser->args[i].type;
+            if (type == PMARGP_MMAP_FILE) {
+                unmap_file(&context->values[i].map);
+            } else if (type >= PMARGP_R_FILE && type <= PMARGP_B_RW_FILE) {
+                fclose(context->values[i].file);
+            }
+        }
+    }
+    unmap_all(&context->arena.allocator, &context->mappings);
+    arena_release(&context->arena);
+    if (context->present) memset(context->present, 0, ((size_t)parser->argc + 63) / 64 * sizeof(uint64_t));
+    context->pending = -1;
+    context->operands = 0;
+    memset(&context->remainder, 0, sizeof(context->remainder));
+    context->help = false;
+    context->error = PMARGP_SUCCESS;
+    context->error_index = -1;
+    context->error_token = NULL;
+    context->error_element = 0;
+}
+
+void pmargp_context_free(pmargp_context_t *context) {
+    if (!context || !context->parser) return;
+    pmargp_context_reset(context);
+    const pmargp_allocator_t *allocator = &context->arena.allocator;
+    if (context->values && allocator->free) allocator->free(allocator->ctx, context->values);
+    memset(context, 0, sizeof(*context));
+}
+
+int pmargp_parse_context(pmargp_context_t *context, int argc, char *argv[]) {
+    if (!context || !context->parser) return PMARGP_ERR_NULL;
+    pmargp_context_reset(context);
+    if (context->parser->argc == 0) return context->error = PMARGP_ERR_NO_ARGUMENTS;
+
+    parse_state_t state = context_state(context);
+    int error = expand_arguments(&state, &argc, &argv);
+    if (error == PMARGP_SUCCESS) {
+        STAT_CLOCK(start);
+        error = lex_argv(&state, argc, argv);
+        STAT_ELAPSED(state.stats, lex_ns, start);
+    }
+    if (error == PMARGP_HELP_REQUESTED) {
+        context->help = true;  // reported, never printed or exited on
+        context->error_index = -1;
+        context->error_token = NULL;
+        return context->error = PMARGP_SUCCESS;
+    }
+    if (error == PMARGP_SUCCESS) error = finish_parse(&state);
+    return context->error = error;
+}
+
+int pmargp_context_stats(const pmargp_context_t *context, pmargp_stats_t *out) {
+    if (!context || !out) return PMARGP_ERR_NULL;
+    return copy_stats(&context->stats, &context->arena, out);
+}
+
+bool pmargp_context_has(const pmargp_context_t *context, const char *key) {
+    return pmargp_context_get(context, key) != NULL;
+}
+
+const pmargp_value_t *pmargp_context_get(const pmargp_context_t *context, const char *key) {
+    if (!context || !context->parser || !key) return NULL;
+    int idx = find_argument(context->parser, key, strlen(key));
+    return idx >= 0 && bit_test(context->present, idx) ? &context->values[idx] : NULL;
+}
+
+const pmargp_value_t *pmargp_context_positional(const pmargp_context_t *context, int position) {
+    if (!context || !context->parser || position < 0 || position >= context->parser->positional_count) return NULL;
+    int idx = context->parser->positionals[position];
+    return bit_test(context->present, idx) ? &context->values[idx] : NULL;
+}
+
+pmargp_source_t pmargp_context_source(const pmargp_context_t *context, const char *key) {
+    if (!context || !context->parser || !key) return PMARGP_SOURCE_NONE;
+    int idx = find_argument(context->parser, key, strlen(key));
+    return idx >= 0 && bit_test(context->present, idx) ? (pmargp_source_t)context->sources[idx] : PMARGP_SOURCE_NONE;
+}
+
+static int add_positional(struct pmargp_parser_t *parser, const char *name, pmargp_type_t type,
+                          void *value_ptr, const char *description, int flags) {
+    if (parser->frozen) return PMARGP_ERR_FROZEN;
+    if (type < PMARGP_FLOAT || type > PMARGP_CHOICE || type == PMARGP_BOOL) return PMARGP_ERR_UNKNOWN_TYPE;
+
+    // growing args is safe to keep on failure, the rest is rolled back
+    if (args_reserve(parser, 1) != PMARGP_SUCCESS) return PMARGP_ERR_MEMORY_ALLOCATION;
+    arena_mark_t mark = arena_mark(&parser->arena);
+    int *positionals = arena_grow(&parser->arena, parser->positionals,
+                                  (size_t)parser->positional_count * sizeof(int),
+                                  (size_t)(parser->positional_count + 1) * sizeof(int));
+    bool borrowed = (flags | parser->flags) & PMARGP_FLAG_BORROWED;
+    char *name_copy = borrowed ? (char *)name : arena_strdup(&parser->arena, name);
+    char *description_copy = borrowed ? (char *)description : NULL;
+    int *required_args = parser->required_args, required_count = parser->required_count;
+    if (!positionals || !name_copy ||
+        (description && !borrowed && !(description_copy = arena_strdup(&parser->arena, description))) ||
+        ((flags & PMARGP_FLAG_REQUIRED) &&
+         push_index(&parser->arena, &parser->required_args, &parser->required_count, parser->argc) != PMARGP_SUCCESS)) {
+        arena_rewind(&parser->arena, mark);
+        parser->required_args = required_args;
+        parser->required_count = required_count;
+        return PMARGP_ERR_MEMORY_ALLOCATION;
+    }
+
+    int idx = parser->argc;
+    pmargp_argument_t *arg = &parser->args[idx];
+    memset(arg, 0, sizeof(*arg));
+    arg->name = name_copy;
+    arg->description = description_copy;
+    arg->value_ptr = value_ptr;
+    arg->type = type;
+    arg->required = (flags & PMARGP_FLAG_REQUIRED) != 0;
+    arg->lazy = (flags & PMARGP_FLAG_LAZY) != 0;
+    arg->source = PMARGP_SOURCE_NONE;
+    positionals[parser->positional_count++] = idx;
+    parser->positionals = positionals;
+    int width = (int)strlen(name_copy);
+    if (width > parser->help_key_width) parser->help_key_width = width;
+    parser->argc++;
+    return PMARGP_SUCCESS;
+}
+
+int pmargp_add_positional(struct pmargp_parser_t *parser, const char *name, pmargp_type_t type,
+                          void *value_ptr, const char *description, int flags) {
+    if (!parser || !name) return PMARGP_ERR_NULL;
+    STAT_CLOCK(start);
+    int error = add_positional(parser, name, type, value_ptr, description, flags);
+    STAT_ELAPSED(&parser->stats, registration_ns, start);
+    return error;
+}
+
+int pmargp_add_command(struct pmargp_parser_t *parser, const char *name, const char *description,
+                       pmargp_builder_t build, void *data) {
+    if (!parser || !name || !build) return PMARGP_ERR_NULL;
+    if (parser->frozen) return PMARGP_ERR_FROZEN;
+    size_t len = strlen(name);
+    if (find_command(parser, name, len)) {
+        fprintf(stderr, "Command %s already exists\n", name);
+        return PMARGP_ERR_EXISTING_ARGUMENT;
+    }
+
+    arena_mark_t mark = arena_mark(&parser->arena);
+    int count = parser->command_count;
+    pmargp_command_t *commands = parser->commands;
+    if (count == 0 || (count >= 4 && (count & (count - 1)) == 0)) {
+        // capacity doubles from 4, so registering n commands copies O(n)
+        size_t capacity = count ? (size_t)count * 2 : 4;
+        commands = arena_grow(&parser->arena, commands, (size_t)count * sizeof(*commands),
+                              capacity * sizeof(*commands));
+        if (!commands) return PMARGP_ERR_MEMORY_ALLOCATION;
+    }
+    pmargp_command_t command = {name, description, build, data};
+    if (!(parser->flags & PMARGP_FLAG_BORROWED)) {
+        command.name = arena_strndup(&parser->arena, name, len);
+        command.description = description ? arena_strdup(&parser->arena, description) : NULL;
+        if (!command.name || (description && !command.description)) {
+            arena_rewind(&parser->arena, mark);
+            return PMARGP_ERR_MEMORY_ALLOCATION;
+        }
+    }
+    commands[count] = command;
+    parser->commands = commands;
+    parser->command_count = count + 1;
+    return PMARGP_SUCCESS;
+}
+
+int pmargp_set_remainder(struct pmargp_parser_t *parser, pmargp_span_t *sink) {
+    if (!parser) return PMARGP_ERR_NULL;
+    if (parser->frozen) return PMARGP_ERR_FROZEN;
+    parser->remainder = sink;
+    if (sink) memset(sink, 0, sizeof(*sink));
+    return PMARGP_SUCCESS;
+}
+
+int pmargp_set_open_workers(struct pmargp_parser_t *parser, int workers) {
+    if (!parser) return PMARGP_ERR_NULL;
+    if (parser->frozen) return PMARGP_ERR_FROZEN;
+    if (workers < 1) return PMARGP_ERR_INVALID_VALUE;
+    parser->open_workers = workers;
+    return PMARGP_SUCCESS;
+}
+
+// Record a newly bound argument in env_args for merge_environment
+static int track_env(struct pmargp_parser_t *parser, const pmargp_argument_t *arg) {
+    return push_index(&parser->arena, &parser->env_args, &parser->env_count, (int)(arg - parser->args));
+}
+
+int pmargp_bind_env(struct pmargp_parser_t *parser, const char *key, const char *name) {
+    if (!parser || !key || !name) return PMARGP_ERR_NULL;
+    if (parser->frozen) return PMARGP_ERR_FROZEN;
+    pmargp_argument_t *arg = get_argument(parser, key);
+    if (!arg) return PMARGP_ERR_INVALID_KEY;
+    char *copy = arena_strdup(&parser->arena, name);
+    if (!copy || (!arg->env && track_env(parser, arg) != PMARGP_SUCCESS)) return PMARGP_ERR_MEMORY_ALLOCATION;
+    arg->env = copy;
+    return PMARGP_SUCCESS;
+}
+
+int pmargp_bind_env_prefix(struct pmargp_parser_t *parser, const char *prefix) {
+    if (!parser || !prefix) return PMARGP_ERR_NULL;
+    if (parser->frozen) return PMARGP_ERR_FROZEN;
+    size_t prefix_len = strlen(prefix);
+    for (int i = 0; i < parser->argc; i++) {
+        pmargp_argument_t *arg = &parser->args[i];
+        if (arg->env || !arg->key) continue;
+        const char *key = arg->key;
+        while (*key == '-') key++;
+        size_t key_len = strlen(key);
+        char *name = arena_alloc(&parser->arena, prefix_len + key_len + 1);
+        if (!name) return PMARGP_ERR_MEMORY_ALLOCATION;
+        memcpy(name, prefix, prefix_len);
+        for (size_t j = 0; j < key_len; j++) {
+            char c = key[j];
+            name[prefix_len + j] = c == '-' ? '_' : (c >= 'a' && c <= 'z') ? (char)(c - 'a' + 'A') : c;
+        }
+        name[prefix_len + key_len] = '\0';
+        if (track_env(parser, arg) != PMARGP_SUCCESS) return PMARGP_ERR_MEMORY_ALLOCATION;
+        arg->env = name;
+    }
+    return PMARGP_SUCCESS;
+}
+
+int pmargp_set_config_file(struct pmargp_parser_t *parser, const char *path) {
+    if (!parser) return PMARGP_ERR_NULL;
+    if (parser->frozen) return PMARGP_ERR_FROZEN;
+    char *copy = NULL;
+    if (path && !(copy = arena_strdup(&parser->arena, path))) return PMARGP_ERR_MEMORY_ALLOCATION;
+    parser->config_path = copy;
+    return PMARGP_SUCCESS;
+}
+
+void parser_start(struct pmargp_parser_t *parser) {
+    parser_start_with_allocator(parser, NULL);
+}
+
+void parser_start_with_allocator(struct pmargp_parser_t *parser, const pmargp_allocator_t *allocator) {
+    if (parser) {
+        parser->argc = 0;
+        parser->args = NULL;
+        parser->capacity = 0;
+        parser->name = NULL;
+        parser->description = NULL;
+        parser->flags = 0;
+        memset(&parser->index, 0, sizeof(parser->index));
+        parser->arena.head = NULL;
+        parser->mappings = NULL;
+        parser->expansion = NULL;
+        parser->expansion_capacity = 0;
+        parser->pending = -1;
+        parser->frozen = false;
+        parser->required = NULL;
+        parser->help_key_width = 0;
+        parser->help_short_width = 0;
+        parser->config_path = NULL;
+        parser->positionals = NULL;
+        parser->positional_count = 0;
+        parser->env_args = NULL;
+        parser->env_count = 0;
+        parser->required_args = NULL;
+        parser->required_count = 0;
+        parser->operands = 0;
+        parser->remainder = NULL;
+        parser->commands = NULL;
+        parser->command_count = 0;
+        parser->parent = NULL;
+        parser->selected = NULL;
+        parser->open_workers = PMARGP_OPEN_WORKERS;
+        memset(&parser->stats, 0, sizeof(parser->stats));
+        if (allocator && allocator->alloc) {
+            parser->arena.allocator = *allocator;
+        } else {
+            parser->arena.allocator.alloc = default_alloc;
+            parser->arena.allocator.free = default_free;
+            parser->arena.allocator.ctx = NULL;
+        }
+        parser->add_argument = add_argument;
+        parser->parses = parses;
+        parser->get_argument = get_argument;
+        parser->get_argument_index = get_argument_index;
+    }
+}
+
+void free_parser(struct pmargp_parser_t *parser) {
+    if (!parser) return;
+    release_command(parser);
+
+    for (int i = 0; i < parser->argc; i++) {
+        pmargp_argument_t *arg = &parser->args[i];
+        if (!arg->owned) continue;
+        if (arg->type == PMARGP_MMAP_FILE) {
+            unmap_file((pmargp_mmap_t*)arg->value_ptr);
+        } else {
+            fclose(*(FILE**)arg->value_ptr);
+            *(FILE**)arg->value_ptr = NULL;
+        }
+        arg->owned = false;
+    }
+    unmap_all(&parser->arena.allocator, &parser->mappings);
+    arena_release(&parser->arena);
+    parser->expansion = NULL;
+    parser->expansion_capacity = 0;
+    memset(&parser->index, 0, sizeof(parser->index));
     parser->args = NULL;
     parser->argc = 0;
-}
\ No newline at end of file
+    parser->capacity = 0;
+    parser->frozen = false;
+    parser->required = NULL;
+    parser->help_key_width = 0;
+    parser->help_short_width = 0;
+    parser->config_path = NULL;
+    parser->positionals = NULL;
+    parser->positional_count = 0;
+    parser->env_args = NULL;
+    parser->env_count = 0;
+    parser->required_args = NULL;
+    parser->required_count = 0;
+    parser->operands = 0;
+    parser->remainder = NULL;
+    parser->commands = NULL;
+    parser->command_count = 0;
+}
@@ -60,6 +60,8 @@ typedef int bool;
 #endif
 
 #include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
 
 /**
  * @brief Library version
@@ -71,6 +73,17 @@ typedef int bool;
  */
 #define PMARGP_FLAG_REQUIRED 0x01  // Argument is required
 #define PMARGP_FLAG_OPTIONAL 0x00  // Argument is optional
+#define PMARGP_FLAG_BORROWED 0x02  // Keep the caller's key, short key and description pointers instead of copying them;
+                                   // they must outlive the parser (string literals usually do)
+#define PMARGP_FLAG_LAZY     0x04  // Defer fopen of file arguments to pmargp_open_file/pmargp_open_files;
+                                   // the parser then owns the FILE and free_parser closes it
+#define PMARGP_FLAG_NO_EXIT  0x08  // Parser-wide: on --help return PMARGP_HELP_REQUESTED instead of printing
+                                   // the help and calling exit()
+#define PMARGP_FLAG_ABBREV   0x10  // Parser-wide: accept unique prefixes of long keys ("--out" for "--output")
+#define PMARGP_FLAG_BATCH    0x20  // Parser-wide: parses collects file arguments and opens them together once the
+                                   // command line is read, on pmargp_set_open_workers threads
+
+#define PMARGP_OPEN_WORKERS 4 // Threads opening a PMARGP_FLAG_BATCH batch unless pmargp_set_open_workers says otherwise
 
 
 /**
@@ -86,6 +99,23 @@ typedef int bool;
 #define PMARGP_ERR_MEMORY_ALLOCATION 0x08
 #define PMARGP_ERR_EXISTING_ARGUMENT 0x09
 #define PMARGP_ERR_INVALID_KEY 0x0a
+#define PMARGP_ERR_RESPONSE_DEPTH 0x0b
+#define PMARGP_ERR_FROZEN 0x0c
+#define PMARGP_ERR_NOT_FROZEN 0x0d
+#define PMARGP_HELP_REQUESTED 0x0e  // Not an error: --help was given under PMARGP_FLAG_NO_EXIT
+#define PMARGP_ERR_AMBIGUOUS 0x0f   // An abbreviated long key matches more than one argument
+#define PMARGP_ERR_NO_STATS 0x10    // pmargp_stats without PMARGP_STATS defined when building the library
+#define PMARGP_ERR_UNKNOWN_COMMAND 0x11 // The operand in command position names no subcommand
+
+/**
+ * @brief Maximum nesting of @file response files (an @file inside an @file counts as two)
+ */
+#define PMARGP_MAX_RESPONSE_DEPTH 8
+
+/**
+ * @brief Largest choice table that is perfect-hashed, larger ones are binary searched
+ */
+#define PMARGP_CHOICE_HASH_MAX 64
 
 
 /**
@@ -102,9 +132,150 @@ typedef enum {
     PMARGP_RW_FILE,  ///< Read-write file
     PMARGP_B_R_FILE, ///< Binary read-only file
     PMARGP_B_W_FILE, ///< Binary write-only file
-    PMARGP_B_RW_FILE ///< Binary read-write file
+    PMARGP_B_RW_FILE, ///< Binary read-write file
+    PMARGP_INT64,    ///< 64-bit signed integer (int64_t)
+    PMARGP_UINT64,   ///< 64-bit unsigned integer (uint64_t)
+    PMARGP_SIZE,     ///< Size or count (size_t)
+    PMARGP_DOUBLE,   ///< Double precision floating-point number
+    PMARGP_MMAP_FILE, ///< Read-only memory-mapped file (pmargp_mmap_t)
+    PMARGP_INT_LIST,    ///< Delimited list of integers (pmargp_list_t)
+    PMARGP_FLOAT_LIST,  ///< Delimited list of floats (pmargp_list_t)
+    PMARGP_DOUBLE_LIST, ///< Delimited list of doubles (pmargp_list_t)
+    PMARGP_CHOICE       ///< One of a table of names, stored as its int (see pmargp_set_choices)
 } pmargp_type_t;
 
+#define PMARGP_TYPE_COUNT (PMARGP_CHOICE + 1)
+
+
+/**
+ * @brief Counters and timings of a parser, or of the parses of a context.
+ *
+ * Only collected when the library is built with -DPMARGP_STATS. Without it
+ * the instrumentation compiles to nothing and the counters stay zero.
+ * Timings are monotonic-clock nanoseconds, accumulated across calls; file
+ * opening happens during dispatch and is included in lex_ns as well.
+ */
+typedef struct pmargp_stats_t
+{
+    uint64_t tokens;         ///< Tokens run through the lexer
+    uint64_t lookups;        ///< Key table lookups
+    uint64_t key_compares;   ///< String comparisons made by the lookups
+    uint64_t conversions[PMARGP_TYPE_COUNT]; ///< Values stored, by pmargp_type_t
+    uint64_t files_opened;   ///< fopen and mmap calls for file arguments
+    uint64_t registration_ns; ///< pmargp_add_arguments, add_argument and pmargp_add_positional
+    uint64_t lex_ns;         ///< Lexing and dispatch of the tokens
+    uint64_t file_open_ns;   ///< Opening and mapping file arguments
+    uint64_t required_ns;    ///< Merging the other sources and checking required arguments
+    size_t arena_bytes;      ///< Bytes held by the arena, filled in by pmargp_stats
+} pmargp_stats_t;
+
+
+/**
+ * @brief View of the operands left over after the positional arguments.
+ *
+ * When they form one run in argv, as in "tool -v a b c", items points
+ * straight into argv and capacity is 0. Otherwise the pointers are gathered
+ * into an array owned by the parser (or context). The strings themselves are
+ * never copied, except tokens handed to pmargp_feed.
+ */
+typedef struct pmargp_span_t
+{
+    char **items;  ///< First operand, NULL when count is 0
+    int count;     ///< Number of operands
+    int capacity;  ///< Slots of an owned array, 0 while items points into argv
+} pmargp_span_t;
+
+
+/**
+ * @brief Allowed value of a PMARGP_CHOICE argument and the int it stands for.
+ */
+typedef struct pmargp_choice_t
+{
+    const char *name; ///< Text accepted on the command line (e.g., "fast")
+    int value;        ///< Written through value_ptr when name is given
+} pmargp_choice_t;
+
+
+/**
+ * @brief Where an argument's value came from, in increasing precedence.
+ */
+typedef enum {
+    PMARGP_SOURCE_NONE,   ///< Not given, the variable keeps its default
+    PMARGP_SOURCE_CONFIG, ///< Config file set with pmargp_set_config_file
+    PMARGP_SOURCE_ENV,    ///< Environment variable bound with pmargp_bind_env
+    PMARGP_SOURCE_ARGV    ///< Command line (parses, pmargp_feed, pmargp_parse_string)
+} pmargp_source_t;
+
+
+/**
+ * @brief madvise hints for PMARGP_MMAP_FILE, combined in pmargp_mmap_t.advice
+ */
+#define PMARGP_MADV_NORMAL     0x00  // No hint
+#define PMARGP_MADV_SEQUENTIAL 0x01  // Read front to back, aggressive read-ahead
+#define PMARGP_MADV_WILLNEED   0x02  // Start paging the whole file in now
+#define PMARGP_MADV_HUGEPAGE   0x04  // Back the mapping with huge pages where supported
+
+
+/**
+ * @brief Read-only view of a PMARGP_MMAP_FILE argument.
+ *
+ * Set `advice` before parsing; parses fills in `data` and `size`. The mapping
+ * is owned by the parser and unmapped by free_parser.
+ */
+typedef struct pmargp_mmap_t
+{
+    const unsigned char *data; ///< Start of the file contents, NULL until mapped
+    size_t size;               ///< Length of the file in bytes
+    int advice;                ///< PMARGP_MADV_* hints applied after mapping
+} pmargp_mmap_t;
+
+
+/**
+ * @brief Value of a PMARGP_INT_LIST, PMARGP_FLOAT_LIST or PMARGP_DOUBLE_LIST argument.
+ *
+ * Set `delimiter` before parsing (',' when left as '\0'). parses converts
+ * every element into one exactly sized array in the parser's arena, released
+ * by free_parser; an empty value gives an empty list. When an element fails
+ * to convert, parses returns PMARGP_ERR_INVALID_VALUE and `error_element`
+ * holds its position. Contexts leave the failed value absent and report the
+ * position in pmargp_context_t.error_element instead.
+ */
+typedef struct pmargp_list_t
+{
+    union {
+        int *i;     ///< PMARGP_INT_LIST elements
+        float *f;   ///< PMARGP_FLOAT_LIST elements
+        double *d;  ///< PMARGP_DOUBLE_LIST elements
+    } data;
+    size_t count;         ///< Number of elements
+    char delimiter;       ///< Separator between elements
+    size_t error_element; ///< Element that failed to convert
+} pmargp_list_t;
+
+
+/**
+ * @brief Parsed value of one argument in a pmargp_context_t.
+ *
+ * The member matching the argument's type is set: i (INT), f (FLOAT),
+ * d (DOUBLE), i64, u64, size, b (BOOL), c (CHAR), s (STRING), file (file
+ * types), map (MMAP_FILE) or list (the list types).
+ */
+typedef union pmargp_value_t
+{
+    int i;
+    float f;
+    double d;
+    int64_t i64;
+    uint64_t u64;
+    size_t size;
+    bool b;
+    char c;
+    char *s;
+    FILE *file;
+    pmargp_mmap_t map;
+    pmargp_list_t list;
+} pmargp_value_t;
+
 
 /**
  * @brief Structure representing a command-line argument.
@@ -118,20 +289,157 @@ typedef struct pmargp_argument_t
     pmargp_type_t type;   ///< Type of the argument
     bool required;     ///< Whether the argument is required
     bool allocated;    ///< Indicates if memory was dynamically allocated for this argument
+    bool lazy;         ///< File is opened on first access rather than by parses
+    bool owned;        ///< FILE or mapping was opened by the parser and is released by free_parser
+    const char *path;  ///< Path of a deferred file argument (points into argv)
+    const char *env;   ///< Environment variable bound to the argument, NULL if none
+    char *name;        ///< Name of a positional argument, NULL for options
+    pmargp_source_t source; ///< Source the value came from in the last parse
+    struct pmargp_choices_t *choices; ///< Compiled table of a PMARGP_CHOICE argument, NULL until set
 } pmargp_argument_t;
 
 
+/**
+ * @brief Static description of an argument, for registering whole tables at once.
+ *
+ * Fields mirror the parameters of add_argument, with `flags` taking
+ * PMARGP_FLAG_REQUIRED or PMARGP_FLAG_OPTIONAL.
+ */
+typedef struct pmargp_spec_t
+{
+    const char *short_key;   ///< Short form of the argument (e.g., "-o"), may be NULL
+    const char *key;         ///< Long form of the argument (e.g., "--output"), may be NULL
+    pmargp_type_t type;      ///< Type of the argument
+    void *value_ptr;         ///< Pointer to store the parsed value
+    const char *description; ///< Description of the argument, may be NULL
+    int flags;               ///< PMARGP_FLAG_* bits (REQUIRED, BORROWED, LAZY)
+} pmargp_spec_t;
+
+
+/**
+ * @brief Memory allocator the parser draws all of its storage from.
+ *
+ * The parser only ever asks for whole arena blocks and releases them in
+ * free_parser, so callbacks backed by a per-request pool work as well as
+ * malloc/free.
+ */
+typedef struct pmargp_allocator_t
+{
+    void *(*alloc)(void *ctx, size_t size); ///< Allocate `size` bytes, NULL on failure
+    void (*free)(void *ctx, void *ptr);     ///< Release memory obtained from alloc (may be NULL for pools)
+    void *ctx;                              ///< User context passed to both callbacks
+} pmargp_allocator_t;
+
+
+/**
+ * @brief Growing arena holding the parser's strings, args array and key index.
+ */
+typedef struct pmargp_arena_t
+{
+    struct pmargp_arena_block_t *head; ///< Current block, older blocks are chained behind it
+    pmargp_allocator_t allocator;      ///< Source of the arena blocks
+} pmargp_arena_t;
+
+
+/**
+ * @brief Slot of the long key hash table.
+ */
+typedef struct pmargp_slot_t
+{
+    uint32_t hash; ///< Cached hash of the long key stored in this slot
+    int index;     ///< Index into the parser's args + 1, 0 marks an empty slot
+} pmargp_slot_t;
+
+
+/**
+ * @brief Entry of the sorted long key array used for abbreviations.
+ */
+typedef struct pmargp_prefix_t
+{
+    const char *key; ///< Long key, kept next to its index so that binary search stays in the array
+    int index;       ///< Index into the parser's args
+} pmargp_prefix_t;
+
+
+/**
+ * @brief Key index owned by the parser.
+ *
+ * Long keys live in an open-addressing (linear probing) hash table, single
+ * letter short keys in a direct table of 52 slots ("-a".."-z", "-A".."-Z").
+ * Both are kept up to date by add_argument and released by free_parser.
+ * Abbreviations are resolved by binary search over a sorted copy of the long
+ * keys, rebuilt once after registration changes.
+ */
+typedef struct pmargp_index_t
+{
+    pmargp_slot_t *slots; ///< Long key table, NULL until the first long key is added
+    size_t capacity;      ///< Number of slots, zero or a power of two
+    size_t count;         ///< Number of occupied slots
+    int shorts[52];       ///< Short key table, index into args + 1, 0 marks an empty slot
+    pmargp_prefix_t *sorted; ///< Long keys in strcmp order, NULL until first needed
+    size_t sorted_count;     ///< Number of entries in sorted
+    int sorted_argc;         ///< Parser argc sorted was built for, stale when it differs
+} pmargp_index_t;
+
+
 /**
  * @brief Structure representing the argument parser.
  */
 typedef struct pmargp_parser_t pmargp_parser_t;
 
+/**
+ * @brief Registers a subcommand's arguments once the command is selected.
+ *
+ * Called with a started parser named after the command, carrying the
+ * parent's parser-wide flags. Return PMARGP_SUCCESS, or an error code to
+ * fail the parse with it.
+ */
+typedef int (*pmargp_builder_t)(struct pmargp_parser_t *parser, void *data);
+
+/**
+ * @brief Subcommand registered with pmargp_add_command.
+ */
+typedef struct pmargp_command_t
+{
+    const char *name;        ///< Operand selecting the command
+    const char *description; ///< Shown in the parent's help, may be NULL
+    pmargp_builder_t build;  ///< Registers the command's arguments
+    void *data;              ///< Passed to build
+} pmargp_command_t;
+
 struct pmargp_parser_t
 {
     const char *name;        ///< Name of the program
     const char *description; ///< Description of the program
+    int flags;               ///< Parser-wide PMARGP_FLAG_* bits, BORROWED and LAZY apply to every argument
     int argc;                ///< Number of arguments
     pmargp_argument_t *args;        ///< Array of arguments
+    size_t capacity;         ///< Number of args slots available before the array has to grow
+    pmargp_index_t index;    ///< Key index over args
+    pmargp_arena_t arena;    ///< Backing storage for args, index and copied strings
+    struct pmargp_mapping_t *mappings; ///< Response and config files; those a value points into live until free_parser
+    char **expansion;        ///< argv expanded from response files, reused by every parse
+    size_t expansion_capacity; ///< Slots in expansion
+    int pending;             ///< Argument waiting for its value between pmargp_feed calls, negative when none
+    bool frozen;             ///< Set by pmargp_freeze, the parser is read-only from then on
+    uint64_t *required;      ///< Bitset of required arguments, built by pmargp_freeze
+    int help_key_width;      ///< Longest long key, kept up to date by registration for help rendering
+    int help_short_width;    ///< Longest short key, kept up to date by registration for help rendering
+    const char *config_path; ///< key=value file merged under argv and the environment, NULL if none
+    int *positionals;        ///< Indices into args of the positional arguments, in order
+    int positional_count;    ///< Number of positional arguments
+    int *env_args;           ///< Indices into args of the arguments bound to an environment variable
+    int env_count;           ///< Number of bound arguments
+    int *required_args;      ///< Indices into args of the required arguments, checked by every parse
+    int required_count;      ///< Number of required arguments
+    int operands;            ///< Operands seen by the current parse
+    pmargp_span_t *remainder; ///< Receives the operands past the positionals, NULL to ignore them
+    pmargp_command_t *commands; ///< Subcommands, whose parsers are only built when selected
+    int command_count;       ///< Number of subcommands
+    struct pmargp_parser_t *parent;   ///< Parser this one is a subcommand of, NULL at the top
+    struct pmargp_parser_t *selected; ///< Parser of the command selected by the current parse, NULL if none
+    int open_workers;        ///< Threads opening the file arguments under PMARGP_FLAG_BATCH
+    pmargp_stats_t stats;    ///< Instrumentation, see pmargp_stats
 
     /**
      * @brief Get an argument by its key.
@@ -165,6 +473,12 @@ struct pmargp_parser_t
 
     /**
      * @brief Parse command-line arguments.
+     *
+     * Tokens of the form "@path" are replaced by the words stored in path,
+     * split with the same shell quoting as pmargp_parse_string, up to
+     * PMARGP_MAX_RESPONSE_DEPTH levels deep. A token whose file cannot be
+     * opened is kept as it is. Strings taken from a response file point into
+     * its mapping and stay valid until free_parser.
      * @param parser Pointer to the parser structure.
      * @param argc Number of command-line arguments.
      * @param argv Array of command-line argument strings.
@@ -174,20 +488,397 @@ struct pmargp_parser_t
 
 };
 
+/**
+ * @brief Result of one parse against a frozen parser.
+ *
+ * Contexts hold everything a parse writes, so many of them, e.g. one per
+ * thread, can parse against the same frozen parser concurrently without
+ * locks. A context is reused across parses: pmargp_parse_context resets it
+ * first, which reads the presence bitset a word at a time and only visits
+ * the arguments that were present: options / 64 words plus the present ones.
+ */
+typedef struct pmargp_context_t
+{
+    const struct pmargp_parser_t *parser; ///< Frozen parser this context parses against
+    pmargp_value_t *values;  ///< Parsed values by argument index, valid where the presence bit is set
+    uint64_t *present;       ///< Presence bitset, bit i is set once argument i has its value
+    unsigned char *sources;  ///< pmargp_source_t of each value, valid where the presence bit is set
+    int pending;             ///< Argument waiting for its value, negative when none
+    bool help;               ///< "--help" or "-h" was given; parsing stopped there
+    int error;               ///< Result of the last parse
+    int error_index;         ///< Argument the error refers to, -1 if none
+    const char *error_token; ///< Token that failed to convert, NULL if none
+    size_t error_element;    ///< Element of a list value that failed to convert, see pmargp_list_t
+    int operands;            ///< Operands seen by the last parse
+    pmargp_span_t remainder; ///< Operands past the positionals, if the parser has a remainder sink
+    pmargp_stats_t stats;    ///< Instrumentation of this context's parses, kept across resets
+    pmargp_arena_t arena;    ///< Copies and expanded argv of the current parse
+    struct pmargp_mapping_t *mappings; ///< Response files mapped by the current parse
+} pmargp_context_t;
+
 pmargp_argument_t *get_argument(struct pmargp_parser_t *parser, const char *key);
 int get_argument_index(struct pmargp_parser_t *parser, const char *key);
 int parses(struct pmargp_parser_t *parser, int argc, char *argv[]);
 int add_argument(struct pmargp_parser_t *parser, const char *short_key, const char *key,
                          pmargp_type_t type, void *value_ptr, char *description, bool required);
 
+/**
+ * @brief Register a table of arguments in one go.
+ *
+ * The whole table is validated first (key grammar, types, duplicates against
+ * the parser and within the table), then the args array and key index are
+ * sized once. Registration is atomic: on failure nothing from the table is
+ * registered and the parser is left as it was.
+ * @param parser Pointer to the parser structure.
+ * @param specs Array of argument specifications.
+ * @param n Number of entries in specs.
+ * @return PMARGP_SUCCESS, or the error code of the first offending entry.
+ */
+int pmargp_add_arguments(struct pmargp_parser_t *parser, const pmargp_spec_t *specs, size_t n);
+
+/**
+ * @brief Start an incremental parse fed one token at a time.
+ *
+ * pmargp_begin, any number of pmargp_feed calls and pmargp_finish are
+ * equivalent to parses over the same tokens (without argv[0]), but need no
+ * argv array. The parser remembers which argument is waiting for its value
+ * between calls.
+ * @param parser Pointer to the parser structure.
+ * @return PMARGP_SUCCESS, PMARGP_ERR_NULL or PMARGP_ERR_NO_ARGUMENTS.
+ */
+int pmargp_begin(struct pmargp_parser_t *parser);
+
+/**
+ * @brief Feed the next token of an incremental parse.
+ *
+ * The token does not have to be NUL-terminated or outlive the call: string
+ * values and file paths are copied into the parser's arena. "--help" or "-h"
+ * prints the help and exits, as parses does.
+ * @param parser Pointer to the parser structure.
+ * @param token Token bytes.
+ * @param len Length of token in bytes.
+ * @return PMARGP_SUCCESS, or the error parses would report for this token.
+ */
+int pmargp_feed(struct pmargp_parser_t *parser, const char *token, size_t len);
+
+/**
+ * @brief Finish an incremental parse and check required arguments.
+ *
+ * A key still waiting for its value is dropped, like a trailing key in parses.
+ * @param parser Pointer to the parser structure.
+ * @return PMARGP_SUCCESS or PMARGP_ERR_ARG_MISSING.
+ */
+int pmargp_finish(struct pmargp_parser_t *parser);
+
+/**
+ * @brief Parse a whole command line held in a single string.
+ *
+ * buf is split in place with POSIX shell quoting (single quotes, double
+ * quotes, backslash escapes): quotes and escapes are removed and every token
+ * is NUL-terminated inside buf, then handed straight to the argument table.
+ * Unlike parses there is no program name to skip. Nothing is allocated, and
+ * PMARGP_STRING values point into buf, which must outlive their use.
+ * @param parser Pointer to the parser structure.
+ * @param buf Command line, modified in place; buf[len] must be writable
+ *            (passing strlen(buf) for a C string satisfies this).
+ * @param len Length of the command line in bytes.
+ * @return PMARGP_SUCCESS, PMARGP_ERR_INVALID_VALUE if a quote is left open,
+ *         or the error parses would report.
+ */
+int pmargp_parse_string(struct pmargp_parser_t *parser, char *buf, size_t len);
+
+/**
+ * @brief Render the help text into a buffer.
+ *
+ * Produces the text parses prints for --help in a single pass, with snprintf
+ * semantics: at most cap - 1 bytes are written and the result is always
+ * NUL-terminated when cap > 0. Call with a NULL buffer to size one.
+ * @param parser Pointer to the parser structure.
+ * @param buf Destination buffer, may be NULL when cap is 0.
+ * @param cap Size of buf in bytes.
+ * @return Length of the full help text, excluding the terminator.
+ */
+size_t pmargp_format_help(const struct pmargp_parser_t *parser, char *buf, size_t cap);
+
+/**
+ * @brief List the arguments whose long key starts with prefix.
+ *
+ * Candidates come out in strcmp order of their keys, which is also how
+ * ambiguous abbreviations are reported under PMARGP_FLAG_ABBREV.
+ * @param parser Pointer to the parser structure (a frozen parser is only read).
+ * @param prefix Start of a long key, including its "--".
+ * @param out Receives up to cap matching arguments, may be NULL when cap is 0.
+ * @param cap Capacity of out.
+ * @return Number of matching arguments, which may exceed cap.
+ */
+size_t pmargp_candidates(struct pmargp_parser_t *parser, const char *prefix,
+                         const pmargp_argument_t **out, size_t cap);
+
+/**
+ * @brief Read the parser's instrumentation.
+ *
+ * Counts what the parser did since parser_start: registration, lookups,
+ * conversions and file opening, plus the time each stage took. For a context
+ * use pmargp_context_stats.
+ * @param parser Pointer to the parser structure.
+ * @param out Receives the counters, with arena_bytes measured now.
+ * @return PMARGP_SUCCESS, PMARGP_ERR_NULL, or PMARGP_ERR_NO_STATS when the
+ *         library was built without PMARGP_STATS (out is still filled, with zeroes).
+ */
+int pmargp_stats(const struct pmargp_parser_t *parser, pmargp_stats_t *out);
+
+/**
+ * @brief Freeze the parser so it can be shared by pmargp_context_t parses.
+ *
+ * After this the parser is read-only: registration and the parses family
+ * return PMARGP_ERR_FROZEN. Freeze before handing the parser to other threads.
+ * @param parser Pointer to the parser structure.
+ * @return PMARGP_SUCCESS, PMARGP_ERR_NULL or PMARGP_ERR_MEMORY_ALLOCATION.
+ */
+int pmargp_freeze(struct pmargp_parser_t *parser);
+
+/**
+ * @brief Prepare a context for parsing against a frozen parser.
+ *
+ * The values array and presence bitset are allocated once, through the
+ * parser's allocator (which must then be thread-safe if contexts are
+ * initialised concurrently).
+ * @param context Context to initialise, typically on the stack.
+ * @param parser Frozen parser.
+ * @return PMARGP_SUCCESS, PMARGP_ERR_NOT_FROZEN or PMARGP_ERR_MEMORY_ALLOCATION.
+ */
+int pmargp_context_init(pmargp_context_t *context, const struct pmargp_parser_t *parser);
+
+/**
+ * @brief Parse argv into the context.
+ *
+ * Same rules as parses, except that values are stored in the context rather
+ * than through value_ptr, help is reported in context->help instead of
+ * printed, and file arguments are always opened eagerly. Files, mappings
+ * and copies belong to the context and are released by the next parse,
+ * pmargp_context_reset or pmargp_context_free.
+ * @param context Initialised context.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line argument strings.
+ * @return PMARGP_SUCCESS or an error code, also stored in context->error
+ *         with the offending argument in context->error_index.
+ */
+int pmargp_parse_context(pmargp_context_t *context, int argc, char *argv[]);
+
+/**
+ * @brief Whether the argument with this key was given in the last parse.
+ */
+bool pmargp_context_has(const pmargp_context_t *context, const char *key);
+
+/**
+ * @brief Value of the argument with this key, NULL if it was not given.
+ */
+const pmargp_value_t *pmargp_context_get(const pmargp_context_t *context, const char *key);
+
+/**
+ * @brief Source the value of the argument with this key came from in the last
+ *        parse, PMARGP_SOURCE_NONE if it was not given.
+ */
+pmargp_source_t pmargp_context_source(const pmargp_context_t *context, const char *key);
+
+/**
+ * @brief Value of the positional argument at this position, NULL if it was
+ *        not given.
+ */
+const pmargp_value_t *pmargp_context_positional(const pmargp_context_t *context, int position);
+
+/**
+ * @brief Read the instrumentation of the context's parses, as pmargp_stats does for a parser.
+ */
+int pmargp_context_stats(const pmargp_context_t *context, pmargp_stats_t *out);
+
+/**
+ * @brief Release what the last parse opened and clear the context for reuse.
+ */
+void pmargp_context_reset(pmargp_context_t *context);
+
+/**
+ * @brief Release the context's resources and storage.
+ */
+void pmargp_context_free(pmargp_context_t *context);
+
+/**
+ * @brief Open a deferred file argument on first access.
+ *
+ * With PMARGP_FLAG_LAZY, parses only records the path of file-typed
+ * arguments. The first call opens it with the argument's mode and stores the
+ * FILE in its value_ptr; later calls return the same FILE. Arguments that were
+ * not deferred, or not given on the command line, report what value_ptr holds.
+ * @param parser Pointer to the parser structure.
+ * @param key Long or short key of a file-typed argument.
+ * @param file Receives the FILE, may be NULL.
+ * @return PMARGP_SUCCESS, PMARGP_ERR_FILE_OPEN if fopen fails,
+ *         PMARGP_ERR_INVALID_KEY for an unknown key or PMARGP_ERR_UNKNOWN_TYPE
+ *         if the argument is not a file.
+ */
+int pmargp_open_file(struct pmargp_parser_t *parser, const char *key, FILE **file);
+
+/**
+ * @brief Open every deferred file argument that is still pending.
+ * @param parser Pointer to the parser structure.
+ * @return PMARGP_SUCCESS, or PMARGP_ERR_FILE_OPEN for the first file that
+ *         could not be opened (files opened before it stay open).
+ */
+int pmargp_open_files(struct pmargp_parser_t *parser);
+
+/**
+ * @brief Set how many threads open the file arguments of a batch.
+ *
+ * Under PMARGP_FLAG_BATCH the file-typed arguments of a parse are collected
+ * while the command line is read and opened together after the required
+ * check, by at most `workers` threads. Each FILE or mapping lands in its own
+ * value_ptr whatever the order the opens finish in. If any fails, every
+ * failure is reported, the files of the batch that did open are closed again
+ * and the parse returns PMARGP_ERR_FILE_OPEN. Contexts open inline as before.
+ * @param parser Pointer to the parser structure.
+ * @param workers Thread count, 1 opens in the calling thread.
+ * @return PMARGP_SUCCESS, PMARGP_ERR_NULL, PMARGP_ERR_FROZEN or
+ *         PMARGP_ERR_INVALID_VALUE if workers is below 1.
+ */
+int pmargp_set_open_workers(struct pmargp_parser_t *parser, int workers);
+
+/**
+ * @brief Declare a positional argument.
+ *
+ * Operands, the tokens that are neither options nor option values, fill the
+ * positional arguments in the order they were declared. Everything after
+ * "--" is an operand. String values point into argv.
+ * @param parser Pointer to the parser structure.
+ * @param name Name shown in the usage line and help, copied unless PMARGP_FLAG_BORROWED.
+ * @param type Type of the argument, anything but PMARGP_BOOL.
+ * @param value_ptr Pointer to store the parsed value.
+ * @param description Description of the argument, may be NULL.
+ * @param flags PMARGP_FLAG_REQUIRED or PMARGP_FLAG_OPTIONAL, and PMARGP_FLAG_LAZY.
+ * @return PMARGP_SUCCESS, PMARGP_ERR_UNKNOWN_TYPE, PMARGP_ERR_FROZEN or
+ *         PMARGP_ERR_MEMORY_ALLOCATION.
+ */
+int pmargp_add_positional(struct pmargp_parser_t *parser, const char *name, pmargp_type_t type,
+                          void *value_ptr, const char *description, int flags);
+
+/**
+ * @brief Collect the operands past the positional arguments.
+ *
+ * Without a sink they are ignored. The span is reset by every parse and
+ * stays valid as long as argv (and the parser, for an owned array).
+ * Contexts fill their own copy in pmargp_context_t.remainder.
+ * @param parser Pointer to the parser structure.
+ * @param sink Span to fill, NULL to ignore extra operands again.
+ * @return PMARGP_SUCCESS, PMARGP_ERR_NULL or PMARGP_ERR_FROZEN.
+ */
+int pmargp_set_remainder(struct pmargp_parser_t *parser, pmargp_span_t *sink);
+
+/**
+ * @brief Register a subcommand.
+ *
+ * The first operand past the positional arguments selects a command by
+ * name. Only then is its parser started and handed to build, and every
+ * later token goes to it. Options it does not have are looked up in the
+ * parent, so the parent's options keep working after the command. The
+ * command's parser stays in parser->selected until the next parse,
+ * pmargp_freeze or free_parser; "--help" after the command shows its help. Contexts cannot
+ * build parsers, so pmargp_parse_context fails with PMARGP_ERR_FROZEN on a
+ * command.
+ * @param parser Pointer to the parser structure.
+ * @param name Operand selecting the command, copied unless PMARGP_FLAG_BORROWED.
+ * @param description Shown in the parent's help, may be NULL.
+ * @param build Registers the command's arguments on its parser.
+ * @param data Passed to build.
+ * @return PMARGP_SUCCESS, PMARGP_ERR_NULL, PMARGP_ERR_FROZEN,
+ *         PMARGP_ERR_EXISTING_ARGUMENT for a name taken already, or
+ *         PMARGP_ERR_MEMORY_ALLOCATION.
+ */
+int pmargp_add_command(struct pmargp_parser_t *parser, const char *name, const char *description,
+                       pmargp_builder_t build, void *data);
+
+/**
+ * @brief Set the names a PMARGP_CHOICE argument accepts.
+ *
+ * The table is compiled once, here: up to PMARGP_CHOICE_HASH_MAX names go
+ * into a collision-free hash, so a value costs one hash and one compare;
+ * larger tables are sorted and binary searched. A name outside the table
+ * fails the parse with PMARGP_ERR_INVALID_VALUE. Help lists the names.
+ * @param parser Pointer to the parser structure.
+ * @param key Long or short key, or positional name, of a PMARGP_CHOICE argument.
+ * @param choices Allowed names and their values; names are copied unless PMARGP_FLAG_BORROWED.
+ * @param count Number of entries in choices.
+ * @return PMARGP_SUCCESS, PMARGP_ERR_NULL, PMARGP_ERR_INVALID_KEY for an
+ *         unknown key, PMARGP_ERR_UNKNOWN_TYPE if the argument is not a
+ *         choice, PMARGP_ERR_EXISTING_ARGUMENT for a name listed twice,
+ *         PMARGP_ERR_FROZEN or PMARGP_ERR_MEMORY_ALLOCATION.
+ */
+int pmargp_set_choices(struct pmargp_parser_t *parser, const char *key, const pmargp_choice_t *choices,
+                       size_t count);
+
+/**
+ * @brief Bind an environment variable to an argument.
+ *
+ * When the argument is not on the command line, parses (and the rest of the
+ * parses family) takes its value from the variable instead. Boolean
+ * arguments accept 1/0, true/false, yes/no and on/off.
+ * @param parser Pointer to the parser structure.
+ * @param key Long or short key of the argument.
+ * @param name Name of the variable (e.g., "APP_COUNT"), copied.
+ * @return PMARGP_SUCCESS, PMARGP_ERR_INVALID_KEY for an unknown key,
+ *         PMARGP_ERR_FROZEN or PMARGP_ERR_MEMORY_ALLOCATION.
+ */
+int pmargp_bind_env(struct pmargp_parser_t *parser, const char *key, const char *name);
+
+/**
+ * @brief Bind every argument with a long key to a derived environment variable.
+ *
+ * The name is the prefix followed by the long key without its dashes,
+ * upper-cased, with '-' turned into '_': "--max-count" with prefix "APP_"
+ * binds APP_MAX_COUNT. Arguments bound already keep their variable.
+ * @param parser Pointer to the parser structure.
+ * @param prefix Prefix of every variable, may be empty.
+ * @return PMARGP_SUCCESS, PMARGP_ERR_FROZEN or PMARGP_ERR_MEMORY_ALLOCATION.
+ */
+int pmargp_bind_env_prefix(struct pmargp_parser_t *parser, const char *prefix);
+
+/**
+ * @brief Read defaults from a key=value config file during every parse.
+ *
+ * Each line holds "key = value", where key is a long key with or without its
+ * leading "--" (or a short key), and the value runs to the end of the line
+ * unless it is quoted. Blank lines and lines starting with '#' or ';' are
+ * skipped, as are unknown keys. The file is memory-mapped and tokenized in
+ * place when the parse finishes; it only fills arguments that neither the
+ * command line nor a bound environment variable provided.
+ * @param parser Pointer to the parser structure.
+ * @param path Path of the config file, copied; NULL removes it.
+ * @return PMARGP_SUCCESS, PMARGP_ERR_FROZEN or PMARGP_ERR_MEMORY_ALLOCATION.
+ *         A file that cannot be read makes the parse fail with
+ *         PMARGP_ERR_FILE_OPEN.
+ */
+int pmargp_set_config_file(struct pmargp_parser_t *parser, const char *path);
+
 /**
  * @brief Initialize the parser structure.
  * @param parser Pointer to the parser structure to initialize.
  */
 void parser_start(struct pmargp_parser_t *parser);
 
+/**
+ * @brief Initialize the parser structure with a caller-supplied allocator.
+ * @param parser Pointer to the parser structure to initialize.
+ * @param allocator Allocator for the parser's arena, NULL for malloc/free.
+ *                  The structure is copied, so it may live on the stack.
+ */
+void parser_start_with_allocator(struct pmargp_parser_t *parser, const pmargp_allocator_t *allocator);
+
 /**
  * @brief Free resources allocated by the parser.
+ *
+ * Every string, the args array and the key index live in the parser's arena,
+ * so this hands the arena blocks back to the allocator. Files opened through
+ * pmargp_open_file are closed and their value_ptr reset to NULL, and
+ * PMARGP_MMAP_FILE views are unmapped; files opened eagerly by parses belong
+ * to the caller.
  * @param parser Pointer to the parser structure to free.
  */
 void free_parser(struct pmargp_parser_t *parser);
@@ -0,0 +1,634 @@
+/******************************************************************************************
+ *
+ * @name Poor man's argument parser (pmargp), C++17 interface
+ * @author Luca Vivona
+ *
+ * MIT License
+ * Copyright (c) 2024 Luca Vince Vivona
+ *
+ * Options are declared as a constexpr table bound to members of a plain
+ * struct. Keys are validated and checked for duplicates while the table is
+ * constant-evaluated, and the key lookup is a perfect hash built at the same
+ * time. Parsing then needs no heap allocation and no indirect calls: each
+ * option is dispatched through a fold over its index and converted by a
+ * pmargp::converter specialization for its member type.
+ *
+ *     struct options {
+ *         int count = 1;
+ *         std::string_view name;
+ *         bool quiet = false;
+ *         pmargp::w_file output;
+ *     };
+ *
+ *     constexpr auto cli = pmargp::make_spec(
+ *         pmargp::opt<&options::count>("-c", "--count", "Number of greetings"),
+ *         pmargp::opt<&options::name>("-n", "--name", "Your name", PMARGP_FLAG_REQUIRED),
+ *         pmargp::opt<&options::quiet>(nullptr, "--quiet", "Run in quiet mode"),
+ *         pmargp::opt<&options::output>("-o", "--output", "Output file"));
+ *
+ *     auto result = pmargp::parse(cli, argc, argv);
+ *     if (result.help) pmargp::write_help(cli, stdout, "example_program");
+ *     else if (result.error != PMARGP_SUCCESS) ...
+ *
+ ******************************************************************************************/
+
+#ifndef PMARGP_HPP
+#define PMARGP_HPP
+
+#include "pmargp.h"
+
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace pmargp {
+
+namespace detail {
+
+// Reaching any of these while a spec is constant-evaluated stops compilation
+// with the function name in the diagnostic. Outside constant evaluation they
+// abort, so declare specs `constexpr`.
+inline void invalid_key_in_spec() { std::abort(); }
+inline void duplicate_key_in_spec() { std::abort(); }
+inline void missing_key_in_spec() { std::abort(); }
+inline void perfect_hash_not_found() { std::abort(); }
+
+constexpr bool is_alpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+constexpr bool is_alnum(char c) { return is_alpha(c) || (c >= '0' && c <= '9'); }
+
+// Same grammar as the C library:
+//   long key:  ^--[A-Za-z0-9]+([_-]?[A-Za-z0-9]+)*$
+//   short key: ^-[A-Za-z]$
+constexpr bool is_valid_long_key(std::string_view key) {
+    if (key.size() < 3 || key[0] != '-' || key[1] != '-') return false;
+    bool after_separator = true;
+    for (std::size_t i = 2; i < key.size(); i++) {
+        if (is_alnum(key[i])) {
+            after_separator = false;
+        } else if ((key[i] == '-' || key[i] == '_') && !after_separator) {
+            after_separator = true;
+        } else {
+            return false;
+        }
+    }
+    return !after_separator;
+}
+
+constexpr bool is_valid_short_key(std::string_view key) {
+    return key.size() == 2 && key[0] == '-' && is_alpha(key[1]);
+}
+
+constexpr bool is_help(std::string_view key) {
+    return key == "--help" || key == "-h";
+}
+
+// FNV-1a, 64 bit. The low half picks the bucket and the base slot, the high
+// half (forced odd) is the stride scaled by the bucket's displacement.
+constexpr std::uint64_t hash(std::string_view key) {
+    std::uint64_t h = 14695981039346656037ull;
+    for (char c : key) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+constexpr std::uint32_t slot_of(std::uint64_t h, std::uint32_t displacement, std::size_t mask) {
+    auto base = static_cast<std::uint32_t>(h);
+    auto stride = static_cast<std::uint32_t>(h >> 32) | 1u;
+    return static_cast<std::uint32_t>((base + displacement * stride) & mask);
+}
+
+constexpr std::size_t next_pow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n) p *= 2;
+    return p;
+}
+
+constexpr std::string_view view(const char *s) {
+    return s ? std::string_view(s) : std::string_view("");
+}
+
+template <typename T>
+struct member_traits;
+
+template <typename C, typename T>
+struct member_traits<T C::*> {
+    using class_type = C;
+    using value_type = T;
+};
+
+template <std::size_t I, auto First, auto... Rest>
+struct nth_member : nth_member<I - 1, Rest...> {};
+
+template <auto First, auto... Rest>
+struct nth_member<0, First, Rest...> {
+    static constexpr auto value = First;
+};
+
+template <typename T>
+struct always_false : std::false_type {};
+
+struct option_info {
+    std::string_view short_key;
+    std::string_view key;
+    std::string_view description;
+    std::string_view token;
+    int flags;
+};
+
+} // namespace detail
+
+/**
+ * @brief Open modes matching PMARGP_R_FILE .. PMARGP_B_RW_FILE.
+ */
+enum class file_mode { r, w, rw, b_r, b_w, b_rw };
+
+/**
+ * @brief Move-only owner of a FILE* opened by the parser, closed on destruction.
+ */
+template <file_mode Mode>
+class file {
+public:
+    file() noexcept = default;
+    explicit file(std::FILE *fp) noexcept : fp_(fp) {}
+    file(const file &) = delete;
+    file &operator=(const file &) = delete;
+    file(file &&other) noexcept : fp_(other.release()) {}
+    file &operator=(file &&other) noexcept {
+        if (this != &other) reset(other.release());
+        return *this;
+    }
+    ~file() { reset(); }
+
+    std::FILE *get() const noexcept { return fp_; }
+    explicit operator bool() const noexcept { return fp_ != nullptr; }
+
+    /// Give up ownership without closing.
+    std::FILE *release() noexcept {
+        std::FILE *fp = fp_;
+        fp_ = nullptr;
+        return fp;
+    }
+
+    void reset(std::FILE *fp = nullptr) noexcept {
+        if (fp_) std::fclose(fp_);
+        fp_ = fp;
+    }
+
+    static constexpr const char *mode() {
+        switch (Mode) {
+            case file_mode::r: return "r";
+            case file_mode::w: return "w";
+            case file_mode::rw: return "r+";
+            case file_mode::b_r: return "rb";
+            case file_mode::b_w: return "wb";
+            case file_mode::b_rw: return "rb+";
+        }
+        return "r";
+    }
+
+private:
+    std::FILE *fp_ = nullptr;
+};
+
+using r_file = file<file_mode::r>;
+using w_file = file<file_mode::w>;
+using rw_file = file<file_mode::rw>;
+using b_r_file = file<file_mode::b_r>;
+using b_w_file = file<file_mode::b_w>;
+using b_rw_file = file<file_mode::b_rw>;
+
+/**
+ * @brief Conversion from a command-line token to an option's member type.
+ *
+ * Specializations provide `takes_value`, the help `token`, and
+ * `static int parse(std::string_view text, T &out)` returning a PMARGP_*
+ * code. Specialize it for your own types to bind them to options.
+ */
+template <typename T, typename Enable = void>
+struct converter {
+    static_assert(detail::always_false<T>::value, "pmargp: no converter for this option type");
+};
+
+template <>
+struct converter<bool> {
+    static constexpr bool takes_value = false;
+    static constexpr std::string_view token = "<bool>";
+    static int parse(std::string_view, bool &out) {
+        out = true;
+        return PMARGP_SUCCESS;
+    }
+};
+
+template <>
+struct converter<char> {
+    static constexpr bool takes_value = true;
+    static constexpr std::string_view token = "<char>";
+    static int parse(std::string_view text, char &out) {
+        out = text.empty() ? '\0' : text.front();
+        return PMARGP_SUCCESS;
+    }
+};
+
+template <typename T>
+struct converter<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>>> {
+    static constexpr bool takes_value = true;
+    static constexpr std::string_view token = "<integer>";
+    static int parse(std::string_view text, T &out) {
+        if (!text.empty() && text.front() == '+') text.remove_prefix(1);
+        const char *end = text.data() + text.size();
+        auto [ptr, ec] = std::from_chars(text.data(), end, out, 10);
+        return (ec != std::errc() || ptr != end || text.empty()) ? PMARGP_ERR_INVALID_VALUE : PMARGP_SUCCESS;
+    }
+};
+
+template <typename T>
+struct converter<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+    static constexpr bool takes_value = true;
+    static constexpr std::string_view token = "<float>";
+    static int parse(std::string_view text, T &out) {
+        if (!text.empty() && text.front() == '+') text.remove_prefix(1);
+        const char *end = text.data() + text.size();
+        auto [ptr, ec] = std::from_chars(text.data(), end, out, std::chars_format::general);
+        return (ec != std::errc() || ptr != end || text.empty()) ? PMARGP_ERR_INVALID_VALUE : PMARGP_SUCCESS;
+    }
+};
+
+template <>
+struct converter<std::string_view> {
+    static constexpr bool takes_value = true;
+    static constexpr std::string_view token = "<string>";
+    static int parse(std::string_view text, std::string_view &out) {
+        out = text;
+        return PMARGP_SUCCESS;
+    }
+};
+
+template <file_mode Mode>
+struct converter<file<Mode>> {
+    static constexpr bool takes_value = true;
+    static constexpr std::string_view token = "<file>";
+    // argv tokens are NUL-terminated, which fopen needs
+    static int parse(std::string_view text, file<Mode> &out) {
+        std::FILE *fp = std::fopen(text.data(), file<Mode>::mode());
+        if (fp == nullptr) return PMARGP_ERR_FILE_OPEN;
+        out.reset(fp);
+        return PMARGP_SUCCESS;
+    }
+};
+
+/**
+ * @brief One option bound to a struct member.
+ * @tparam Member Pointer to the member receiving the value (e.g., &options::count).
+ */
+template <auto Member>
+struct opt {
+    using class_type = typename detail::member_traits<decltype(Member)>::class_type;
+    using value_type = typename detail::member_traits<decltype(Member)>::value_type;
+
+    /**
+     * @param short_key Short form (e.g., "-c"), may be nullptr.
+     * @param key Long form (e.g., "--count"), may be nullptr.
+     * @param description Help text, may be nullptr.
+     * @param flags PMARGP_FLAG_REQUIRED or PMARGP_FLAG_OPTIONAL.
+     */
+    constexpr opt(const char *short_key, const char *key, const char *description = nullptr,
+                  int flags = PMARGP_FLAG_OPTIONAL)
+        : info{detail::view(short_key), detail::view(key), detail::view(description),
+               converter<value_type>::token, flags} {}
+
+    detail::option_info info;
+};
+
+/**
+ * @brief Outcome of a parse: the filled struct plus presence and error details.
+ */
+template <typename Opts, auto... Members>
+struct result {
+    Opts values{};                               ///< Parsed values, members keep their defaults when absent
+    int error = PMARGP_SUCCESS;                  ///< PMARGP_SUCCESS or PMARGP_ERR_*
+    int error_index = -1;                        ///< argv index of the offending token, -1 if none
+    std::string_view error_key;                  ///< Key of the offending option, empty if none
+    bool help = false;                           ///< "-h" or "--help" was given, parsing stopped there
+    std::array<bool, sizeof...(Members)> present{}; ///< Which options were given, in declaration order
+
+    /// Whether the option bound to `Member` was given on the command line.
+    template <auto Member>
+    constexpr bool has() const {
+        constexpr std::size_t index = index_of<Member>();
+        static_assert(index < sizeof...(Members), "pmargp: member is not bound by this spec");
+        return present[index];
+    }
+
+private:
+    template <auto A, auto B>
+    static constexpr bool same_member() {
+        if constexpr (std::is_same_v<decltype(A), decltype(B)>) return A == B;
+        else return false;
+    }
+
+    template <auto Member>
+    static constexpr std::size_t index_of() {
+        constexpr bool matches[] = {same_member<Member, Members>()...};
+        for (std::size_t i = 0; i < sizeof...(Members); i++) {
+            if (matches[i]) return i;
+        }
+        return sizeof...(Members);
+    }
+};
+
+/**
+ * @brief Compiled option table with its perfect-hash key lookup.
+ */
+template <auto... Members>
+class spec {
+public:
+    static constexpr std::size_t size = sizeof...(Members);
+    using value_type = typename opt<detail::nth_member<0, Members...>::value>::class_type;
+    using result_type = result<value_type, Members...>;
+
+    static_assert(size > 0, "pmargp: a spec needs at least one option");
+    static_assert(size < 16384, "pmargp: too many options for one spec");
+    static_assert((std::is_same_v<typename opt<Members>::class_type, value_type> && ...),
+                  "pmargp: all options of a spec must bind members of the same struct");
+
+    constexpr explicit spec(opt<Members>... options) : options_{options.info...} {
+        validate();
+        build_lookup();
+    }
+
+    constexpr const detail::option_info &operator[](std::size_t i) const { return options_[i]; }
+
+    /// Index of the option matching `token` exactly, or -1.
+    constexpr int find(std::string_view token) const {
+        std::uint64_t h = detail::hash(token);
+        std::uint32_t displacement = displacements_[static_cast<std::uint32_t>(h) % buckets];
+        std::uint16_t entry = slots_[detail::slot_of(h, displacement, table_size - 1)];
+        if (entry == 0) return -1;
+        const detail::option_info &info = options_[(entry - 1u) >> 1];
+        return (((entry - 1u) & 1u) ? info.short_key : info.key) == token ? static_cast<int>((entry - 1u) >> 1) : -1;
+    }
+
+    /// Whether option `idx` consumes the following token as its value.
+    static constexpr bool takes_value(std::size_t idx) { return takes_value_[idx]; }
+
+    /// Convert `text` into the member bound to option `idx`.
+    static int convert(std::size_t idx, result_type &r, std::string_view text) {
+        return dispatch(idx, r, text, std::make_index_sequence<size>{});
+    }
+
+private:
+    static constexpr bool takes_value_[size] = {converter<typename opt<Members>::value_type>::takes_value...};
+
+    // Expands to a chain of `idx == I` tests over the options in declaration
+    // order, which compilers lower to a jump table of direct calls.
+    template <std::size_t... I>
+    static int dispatch(std::size_t idx, result_type &r, std::string_view text, std::index_sequence<I...>) {
+        int rc = PMARGP_ERR_UNKNOWN_TYPE;
+        (void)((idx == I ? (rc = converter<typename opt<Members>::value_type>::parse(text, r.values.*Members), true)
+                         : false) || ...);
+        return rc;
+    }
+
+    static constexpr std::size_t max_keys = 2 * size;
+    static constexpr std::size_t buckets = size;
+    static constexpr std::size_t table_size = detail::next_pow2(max_keys + max_keys / 4 + 1);
+
+    constexpr void validate() const {
+        for (std::size_t i = 0; i < size; i++) {
+            const detail::option_info &a = options_[i];
+            if (a.key.empty() && a.short_key.empty()) detail::missing_key_in_spec();
+            if (!a.key.empty() && !detail::is_valid_long_key(a.key)) detail::invalid_key_in_spec();
+            if (!a.short_key.empty() && !detail::is_valid_short_key(a.short_key)) detail::invalid_key_in_spec();
+            if (detail::is_help(a.key) || detail::is_help(a.short_key)) detail::duplicate_key_in_spec();
+        }
+    }
+
+    constexpr std::string_view key_of(std::size_t entry) const {
+        return (entry & 1u) ? options_[entry >> 1].short_key : options_[entry >> 1].key;
+    }
+
+    // Hash and displace: keys are grouped into buckets by the low hash bits,
+    // then the largest buckets first each search for a displacement that puts
+    // all of their keys into free slots. Everything is computed once up front
+    // so that specs with hundreds of options stay cheap to constant-evaluate.
+    constexpr void build_lookup() {
+        std::array<std::uint64_t, max_keys> hashes{};
+        std::array<std::uint16_t, max_keys> order{};    // entries grouped by bucket
+        std::array<std::uint32_t, buckets + 1> start{}; // bucket b owns order[start[b], start[b + 1])
+        for (std::size_t entry = 0; entry < max_keys; entry++) {
+            if (key_of(entry).empty()) continue;
+            hashes[entry] = detail::hash(key_of(entry));
+            start[static_cast<std::uint32_t>(hashes[entry]) % buckets + 1]++;
+        }
+
+        std::size_t largest = 0;
+        for (std::size_t b = 0; b < buckets; b++) {
+            if (start[b + 1] > largest) largest = start[b + 1];
+            start[b + 1] += start[b];
+        }
+        std::array<std::uint32_t, buckets> cursor{};
+        for (std::size_t b = 0; b < buckets; b++) cursor[b] = start[b];
+        for (std::size_t entry = 0; entry < max_keys; entry++) {
+            if (key_of(entry).empty()) continue;
+            order[cursor[static_cast<std::uint32_t>(hashes[entry]) % buckets]++] = static_cast<std::uint16_t>(entry);
+        }
+
+        // Equal keys hash alike and so share a bucket, which keeps the
+        // duplicate check linear in the number of keys on average.
+        for (std::size_t b = 0; b < buckets; b++) {
+            for (std::size_t k = start[b]; k < start[b + 1]; k++) {
+                for (std::size_t j = start[b]; j < k; j++) {
+                    if (hashes[order[j]] == hashes[order[k]] && key_of(order[j]) == key_of(order[k])) {
+                        detail::duplicate_key_in_spec();
+                    }
+                }
+            }
+        }
+
+        for (std::size_t want = largest; want > 0; want--) {
+            for (std::size_t b = 0; b < buckets; b++) {
+                if (start[b + 1] - start[b] != want) continue;
+                bool placed = false;
+                for (std::uint32_t d = 0; d < 16 * table_size && !placed; d++) {
+                    placed = try_place(b, d, order, start[b], start[b + 1], hashes);
+                }
+                if (!placed) detail::perfect_hash_not_found();
+            }
+        }
+    }
+
+    constexpr bool try_place(std::size_t b, std::uint32_t d, const std::array<std::uint16_t, max_keys> &order,
+                             std::size_t first, std::size_t last, const std::array<std::uint64_t, max_keys> &hashes) {
+        constexpr std::size_t mask = table_size - 1;
+        for (std::size_t k = first; k < last; k++) {
+            std::uint32_t slot = detail::slot_of(hashes[order[k]], d, mask);
+            if (slots_[slot] != 0) return false;
+            for (std::size_t j = first; j < k; j++) {
+                if (detail::slot_of(hashes[order[j]], d, mask) == slot) return false;
+            }
+        }
+        for (std::size_t k = first; k < last; k++) {
+            slots_[detail::slot_of(hashes[order[k]], d, mask)] = static_cast<std::uint16_t>(order[k] + 1);
+        }
+        displacements_[b] = d;
+        return true;
+    }
+
+    std::array<detail::option_info, size> options_;
+    std::array<std::uint32_t, buckets> displacements_{};
+    std::array<std::uint16_t, table_size> slots_{};
+};
+
+/**
+ * @brief Build a spec from a list of options; declare the result `constexpr`
+ *        so key validation and the lookup table happen at compile time.
+ */
+template <auto... Members>
+constexpr spec<Members...> make_spec(opt<Members>... options) {
+    return spec<Members...>(options...);
+}
+
+/**
+ * @brief Parse argv against a spec.
+ *
+ * Lexes argv like parses(): "--key=value", clusters of short flags such as
+ * "-qv", a short key with its value attached ("-c3") and "--" ending the
+ * options are all accepted. A dash token that matches no key fails with
+ * PMARGP_ERR_INVALID_KEY, while operands, "-" and negative numbers are
+ * skipped. The first occurrence of an option wins and an option missing its
+ * value at the end of argv is left unset. Help never exits, it sets `help`
+ * and stops, and it takes precedence over an error in an earlier token.
+ */
+template <auto... Members>
+typename spec<Members...>::result_type parse(const spec<Members...> &s, int argc, const char *const argv[]) {
+    typename spec<Members...>::result_type r;
+    int pending = -1; // option waiting for the next token, -2 when that value is skipped
+    bool operands_only = false;
+
+    auto fail = [&r](int error, int index, std::string_view key) {
+        r.error = error;
+        r.error_index = index;
+        r.error_key = key;
+    };
+    auto store = [&](int idx, std::string_view text, int index) {
+        if (r.present[idx]) return;
+        int rc = s.convert(static_cast<std::size_t>(idx), r, text);
+        if (rc != PMARGP_SUCCESS) return fail(rc, index, s[idx].key.empty() ? s[idx].short_key : s[idx].key);
+        r.present[idx] = true;
+    };
+    auto take = [&](int idx, bool attached, std::string_view value, int index) {
+        if (attached || !s.takes_value(static_cast<std::size_t>(idx))) return store(idx, value, index);
+        pending = r.present[idx] ? -2 : idx;
+    };
+
+    for (int i = 1; i < argc; i++) {
+        std::string_view token(argv[i]);
+        if (r.error != PMARGP_SUCCESS) {
+            if (token == "--") break;
+            if (!detail::is_help(token)) continue;
+            fail(PMARGP_SUCCESS, -1, std::string_view());
+            r.help = true;
+            return r;
+        }
+        if (operands_only) continue;
+        if (pending != -1) {
+            if (pending >= 0) store(pending, token, i);
+            pending = -1;
+            continue;
+        }
+        if (token.size() < 2 || token[0] != '-' || (token[1] >= '0' && token[1] <= '9') || token[1] == '.') continue;
+
+        if (token[1] != '-') {
+            for (std::size_t j = 1; j < token.size() && r.error == PMARGP_SUCCESS; j++) {
+                const char key[2] = {'-', token[j]};
+                int idx = s.find(std::string_view(key, 2));
+                if (idx < 0 && token[j] == 'h') {
+                    r.help = true;
+                    return r;
+                }
+                if (idx < 0) {
+                    fail(PMARGP_ERR_INVALID_KEY, i, token);
+                } else if (s.takes_value(static_cast<std::size_t>(idx))) {
+                    take(idx, j + 1 < token.size(), token.substr(j + 1), i);
+                    break;
+                } else {
+                    store(idx, std::string_view(), i);
+                }
+            }
+            continue;
+        }
+
+        if (token.size() == 2) {
+            operands_only = true;
+            continue;
+        }
+        std::size_t equals = token.find('=', 2);
+        std::string_view key = token.substr(0, equals);
+        if (equals == std::string_view::npos && detail::is_help(token)) {
+            r.help = true;
+            return r;
+        }
+        int idx = s.find(key);
+        if (idx < 0) {
+            fail(PMARGP_ERR_INVALID_KEY, i, key);
+        } else {
+            bool attached = equals != std::string_view::npos;
+            take(idx, attached, attached ? token.substr(equals + 1) : std::string_view(), i);
+        }
+    }
+    if (r.error != PMARGP_SUCCESS) return r;
+
+    for (std::size_t i = 0; i < sizeof...(Members); i++) {
+        if ((s[i].flags & PMARGP_FLAG_REQUIRED) && !r.present[i]) {
+            r.error = PMARGP_ERR_ARG_MISSING;
+            r.error_key = s[i].key.empty() ? s[i].short_key : s[i].key;
+            return r;
+        }
+    }
+    return r;
+}
+
+template <auto... Members>
+typename spec<Members...>::result_type parse(const spec<Members...> &s, int argc, char *argv[]) {
+    return parse(s, argc, const_cast<const char *const *>(argv));
+}
+
+/**
+ * @brief Print the option table in the same layout as the C help().
+ */
+template <auto... Members>
+void write_help(const spec<Members...> &s, std::FILE *out, const char *name = nullptr,
+                const char *description = nullptr) {
+    std::size_t key_width = 0, short_width = 0;
+    for (std::size_t i = 0; i < s.size; i++) {
+        if (s[i].key.size() > key_width) key_width = s[i].key.size();
+        if (s[i].short_key.size() > short_width) short_width = s[i].short_key.size();
+    }
+
+    std::fprintf(out, "\n%s\n", name ? name : "Program Name");
+    std::fprintf(out, "%s\n\n", description ? description : "No description provided.");
+    std::fprintf(out, "usage: %s [OPTIONS] \n\nOptions:\n", name ? name : "program");
+    for (std::size_t i = 0; i < s.size; i++) {
+        const detail::option_info &o = s[i];
+        std::fprintf(out, "  %-*.*s  %-*.*s%-15.*s%.*s%s\n",
+                     static_cast<int>(key_width + 2), static_cast<int>(o.key.size()), o.key.data(),
+                     static_cast<int>(short_width + 2), static_cast<int>(o.short_key.size()), o.short_key.data(),
+                     static_cast<int>(o.token.size()), o.token.data(),
+                     static_cast<int>(o.description.size()), o.description.data(),
+                     (o.flags & PMARGP_FLAG_REQUIRED) ? " [Required] " : "");
+    }
+    std::fprintf(out, "\n");
+}
+
+} // namespace pmargp
+
+#endif // PMARGP_HPP
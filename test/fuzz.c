@@ -0,0 +1,263 @@
+/*
+ * pmargp fuzz driver
+ *
+ * Decodes each input into a set of option registrations and an argv, then
+ * runs them through add_argument, pmargp_add_positional, pmargp_add_command, parses,
+ * pmargp_parse_string, pmargp_format_help and a frozen context. Build it
+ * with sanitizers so that any out-of-bounds access or undefined behaviour
+ * aborts the run:
+ *
+ *     make fuzz                    # 200000 generated inputs under ASan/UBSan
+ *     bin/fuzz crash-input ...     # replay saved inputs
+ *
+ * With -DPMARGP_LIBFUZZER the file only provides LLVMFuzzerTestOneInput, for
+ * clang -fsanitize=fuzzer,address,undefined.
+ *
+ * Input layout: one byte of parser flags, one byte of option count, then per
+ * option a type byte, a short key byte, a flags byte, a key length byte and
+ * the key. Everything after that is argv, split on NUL bytes.
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "pmargp.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_OPTIONS 32
+#define MAX_KEY 32
+#define MAX_TOKENS 64
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+} fuzz_reader_t;
+
+static int next_byte(fuzz_reader_t *reader) {
+    if (reader->size == 0) return 0;
+    reader->size--;
+    return *reader->data++;
+}
+
+// File types would create and truncate files named by the input
+static pmargp_type_t fuzz_type(int byte) {
+    pmargp_type_t type = (pmargp_type_t)(byte % PMARGP_TYPE_COUNT);
+    if ((type >= PMARGP_R_FILE && type <= PMARGP_B_RW_FILE) || type == PMARGP_MMAP_FILE) return PMARGP_STRING;
+    return type;
+}
+
+typedef struct {
+    char keys[MAX_OPTIONS][MAX_KEY + 3];
+    char shorts[MAX_OPTIONS][3];
+    pmargp_value_t values[MAX_OPTIONS];
+    pmargp_span_t rest;
+    char *argv[MAX_TOKENS + 1];
+    int argc;
+} fuzz_case_t;
+
+static void register_options(struct pmargp_parser_t *parser, fuzz_case_t *input, fuzz_reader_t *reader) {
+    int count = next_byte(reader) % (MAX_OPTIONS + 1);
+    for (int i = 0; i < count; i++) {
+        pmargp_type_t type = fuzz_type(next_byte(reader));
+        int letter = next_byte(reader);
+        int flags = next_byte(reader);
+        size_t len = (size_t)next_byte(reader) % (MAX_KEY + 1);
+        char *key = input->keys[i];
+        key[0] = key[1] = '-';
+        for (size_t j = 0; j < len; j++) key[2 + j] = (char)next_byte(reader);
+        key[2 + len] = '\0';
+        input->shorts[i][0] = '-';
+        input->shorts[i][1] = (char)letter;
+        input->shorts[i][2] = '\0';
+
+        void *value = &input->values[i];
+        if (type >= PMARGP_INT_LIST && type <= PMARGP_DOUBLE_LIST) input->values[i].list.delimiter = (char)(flags >> 4);
+        if (flags & 0x04) {
+            // key + 2 may hold any byte, including none at all
+            pmargp_add_positional(parser, key + 2, type, value, NULL, flags & PMARGP_FLAG_REQUIRED);
+        } else {
+            add_argument(parser, (flags & 0x02) ? input->shorts[i] : NULL, len ? key : NULL, type, value,
+                         NULL, flags & PMARGP_FLAG_REQUIRED);
+        }
+        if (type == PMARGP_CHOICE) {
+            static const pmargp_choice_t choices[] = {{"a", 1}, {"b", 2}, {"fast", 3}, {"0", 4}, {"", 5}};
+            pmargp_set_choices(parser, (flags & 0x04) ? key + 2 : len ? key : input->shorts[i], choices,
+                               (size_t)(flags >> 5) % 6);
+        }
+    }
+}
+
+// argv tokens each get their own allocation, so reads past a terminator trip ASan
+static void split_argv(fuzz_case_t *input, fuzz_reader_t *reader) {
+    input->argv[0] = strdup("fuzz");
+    input->argc = 1;
+    while (reader->size > 0 && input->argc < MAX_TOKENS) {
+        const uint8_t *end = memchr(reader->data, '\0', reader->size);
+        size_t len = end ? (size_t)(end - reader->data) : reader->size;
+        char *token = malloc(len + 1);
+        if (!token) break;
+        memcpy(token, reader->data, len);
+        token[len] = '\0';
+        if (token[0] == '@') token[0] = '+'; // no response files, they would read the filesystem
+        input->argv[input->argc++] = token;
+        reader->data += len;
+        reader->size -= len;
+        if (reader->size) {
+            reader->data++;
+            reader->size--;
+        }
+    }
+    input->argv[input->argc] = NULL;
+}
+
+static char *join_argv(const fuzz_case_t *input, size_t *len) {
+    size_t total = 0;
+    for (int i = 1; i < input->argc; i++) total += strlen(input->argv[i]) + 1;
+    char *buf = malloc(total + 1);
+    if (!buf) return NULL;
+    char *cursor = buf;
+    for (int i = 1; i < input->argc; i++) {
+        size_t n = strlen(input->argv[i]);
+        memcpy(cursor, input->argv[i], n);
+        cursor += n;
+        *cursor++ = ' ';
+    }
+    *cursor = '\0';
+    *len = total;
+    return buf;
+}
+
+// A command reusing the option storage, so that keys clash with the parent's
+static int build_command(struct pmargp_parser_t *parser, void *data) {
+    fuzz_case_t *input = data;
+    add_argument(parser, "-j", "--jobs", PMARGP_INT, &input->values[0], NULL, false);
+    return pmargp_add_positional(parser, "target", PMARGP_STRING, &input->values[1], NULL, 0);
+}
+
+static void start(struct pmargp_parser_t *parser, fuzz_case_t *input, const uint8_t *data, size_t size,
+                  int parser_flags) {
+    fuzz_reader_t reader = {data, size};
+    memset(input, 0, sizeof(*input));
+    parser_start(parser);
+    parser->flags |= PMARGP_FLAG_NO_EXIT | (parser_flags & (PMARGP_FLAG_ABBREV | PMARGP_FLAG_BORROWED));
+    register_options(parser, input, &reader);
+    if (parser_flags & 0x01) pmargp_set_remainder(parser, &input->rest);
+    if (parser_flags & 0x20) {
+        pmargp_add_command(parser, "a", NULL, build_command, input);
+        pmargp_add_command(parser, "build", NULL, build_command, input);
+    }
+    split_argv(input, &reader);
+}
+
+static void finish(struct pmargp_parser_t *parser, fuzz_case_t *input) {
+    free_parser(parser);
+    for (int i = 0; i < input->argc; i++) free(input->argv[i]);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < 1) return 0;
+    int parser_flags = data[0];
+    struct pmargp_parser_t parser;
+    fuzz_case_t *input = malloc(sizeof(fuzz_case_t));
+    if (!input) return 0;
+
+    // argv, and the help text for whatever was registered
+    start(&parser, input, data + 1, size - 1, parser_flags);
+    parses(&parser, input->argc, input->argv);
+    char help[64];
+    size_t needed = pmargp_format_help(&parser, help, sizeof(help));
+    char *full = malloc(needed + 1);
+    if (full) pmargp_format_help(&parser, full, needed + 1);
+    free(full);
+    const pmargp_argument_t *candidates[4];
+    pmargp_candidates(&parser, input->argc > 1 ? input->argv[1] : "--", candidates, 4);
+    finish(&parser, input);
+
+    // the same tokens as a command string
+    start(&parser, input, data + 1, size - 1, parser_flags);
+    size_t len = 0;
+    char *line = join_argv(input, &len);
+    if (line) pmargp_parse_string(&parser, line, len);
+    finish(&parser, input);
+    free(line);
+
+    // a frozen parser and a context parsed twice, to exercise reset
+    start(&parser, input, data + 1, size - 1, parser_flags);
+    if (pmargp_freeze(&parser) == PMARGP_SUCCESS) {
+        pmargp_context_t ctx;
+        if (pmargp_context_init(&ctx, &parser) == PMARGP_SUCCESS) {
+            pmargp_parse_context(&ctx, input->argc, input->argv);
+            pmargp_parse_context(&ctx, input->argc, input->argv);
+            pmargp_context_free(&ctx);
+        }
+    }
+    finish(&parser, input);
+    free(input);
+    return 0;
+}
+
+#ifndef PMARGP_LIBFUZZER
+
+/* ------------------------------------------------------- standalone driver */
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15u;
+
+static uint64_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// Inputs lean towards bytes the lexer cares about, so that generated argv
+// actually reaches options, values, clusters and quoting.
+static size_t generate(uint8_t *buf, size_t cap) {
+    static const char interesting[] = "--=-h\0\0\0abcvxyz0123456789.,;:eE+ '\"\\tTfF@";
+    size_t size = (size_t)(next_random() % cap);
+    for (size_t i = 0; i < size; i++) {
+        uint64_t r = next_random();
+        buf[i] = (r & 3) ? (uint8_t)interesting[(r >> 2) % (sizeof(interesting) - 1)] : (uint8_t)(r >> 8);
+    }
+    return size;
+}
+
+static int replay(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "fuzz: cannot open %s\n", path);
+        return EXIT_FAILURE;
+    }
+    static uint8_t buf[1 << 16];
+    size_t size = fread(buf, 1, sizeof(buf), file);
+    fclose(file);
+    uint8_t *copy = malloc(size ? size : 1); // exact size, so over-reads are caught
+    if (!copy) return EXIT_FAILURE;
+    memcpy(copy, buf, size);
+    LLVMFuzzerTestOneInput(copy, size);
+    free(copy);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "-n") != 0) {
+        int status = EXIT_SUCCESS;
+        for (int i = 1; i < argc; i++) status |= replay(argv[i]);
+        return status;
+    }
+
+    long iterations = argc > 2 ? strtol(argv[2], NULL, 10) : 200000;
+    uint8_t buf[512];
+    for (long i = 0; i < iterations; i++) {
+        size_t size = generate(buf, sizeof(buf));
+        uint8_t *copy = malloc(size ? size : 1);
+        if (!copy) return EXIT_FAILURE;
+        memcpy(copy, buf, size);
+        LLVMFuzzerTestOneInput(copy, size);
+        free(copy);
+    }
+    printf("fuzz: %ld inputs\n", iterations);
+    return EXIT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,308 @@
+/*
+ * pmargp stress suite
+ *
+ * Runs worst-case inputs at several sizes and fails when the measured growth
+ * exceeds the documented complexity:
+ *
+ *     registration        O(n) amortised in the number of options
+ *     parses              O(tokens + bytes + required + env-bound options)
+ *     repeated options    O(tokens), a repeat is dropped without converting
+ *     a short parse       independent of the option count
+ *
+ * Each workload runs at sizes n, 2n, 4n and 8n. Timing on a shared machine
+ * is noisy, so the verdict only uses the fastest of REPETITIONS runs at each
+ * size and compares 8n with n against a generous GROWTH_LIMIT: 24x for a
+ * linear workload, where a quadratic term costs 64x, and 3x where the size
+ * should not matter at all. Built with -DPMARGP_STATS the lexer's counters
+ * are checked as well. They count the same work on every machine, so their
+ * growth must follow the bound almost exactly:
+ *
+ *     make stress
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "pmargp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define STEPS 4
+#define REPETITIONS 7
+#define GROWTH_LIMIT 3.0
+
+// Counted work is exact, this only absorbs a few constant extra steps
+#define WORK_LIMIT 1.25
+
+// Below this the clock and the allocator dominate, so the ratio says nothing
+#define MIN_MEASURABLE_NS 2e5
+
+/* ---------------------------------------------------------------- timing */
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* ------------------------------------------------------------- generators */
+
+typedef struct {
+    int count;
+    size_t key_size;
+    char *keys;      // count keys of key_size bytes each
+    int *values;
+} stress_options_t;
+
+static void *checked(void *ptr) {
+    if (ptr == NULL) {
+        fprintf(stderr, "stress: out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+static const char *key_at(const stress_options_t *options, int i) {
+    return options->keys + (size_t)i * options->key_size;
+}
+
+// Keys that share everything but a numeric suffix: "--shared-prefix-...-<i>"
+static stress_options_t shared_prefix_options(int count) {
+    stress_options_t options = {count, 64, NULL, NULL};
+    options.keys = checked(malloc((size_t)count * options.key_size));
+    options.values = checked(calloc((size_t)count, sizeof(int)));
+    for (int i = 0; i < count; i++) {
+        snprintf(options.keys + (size_t)i * options.key_size, options.key_size,
+                 "--shared-prefix-shared-prefix-shared-prefix-%d", i);
+    }
+    return options;
+}
+
+// Long keys that differ only in their last bytes, so any comparison that
+// reaches them has to read the whole key.
+static stress_options_t last_byte_options(int count) {
+    stress_options_t options = {count, 256, NULL, NULL};
+    options.keys = checked(malloc((size_t)count * options.key_size));
+    options.values = checked(calloc((size_t)count, sizeof(int)));
+    for (int i = 0; i < count; i++) {
+        char *key = options.keys + (size_t)i * options.key_size;
+        memset(key, 'k', options.key_size - 1);
+        key[0] = key[1] = '-';
+        snprintf(key + options.key_size - 9, 9, "%08x", (unsigned)i);
+    }
+    return options;
+}
+
+static void free_options(stress_options_t *options) {
+    free(options->keys);
+    free(options->values);
+}
+
+static void register_options(struct pmargp_parser_t *parser, const stress_options_t *options) {
+    for (int i = 0; i < options->count; i++) {
+        if (add_argument(parser, NULL, key_at(options, i), PMARGP_INT, &options->values[i], NULL,
+                         false) != PMARGP_SUCCESS) {
+            fprintf(stderr, "stress: add_argument failed for option %d\n", i);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// argv of `tokens` entries after argv[0], "<key> <value>" pairs. With
+// `distinct` set the keys cycle through every option, otherwise each key
+// is repeated tokens / options times in a row.
+typedef struct {
+    int argc;
+    char **argv;
+    char *storage;
+} stress_argv_t;
+
+static stress_argv_t make_argv(const stress_options_t *options, long tokens, bool distinct) {
+    stress_argv_t args;
+    args.argc = (int)tokens + 1;
+    args.argv = checked(malloc((size_t)args.argc * sizeof(char *)));
+    args.storage = checked(malloc((size_t)tokens / 2 * 12));
+    args.argv[0] = "stress";
+    long pairs = tokens / 2;
+    long run = pairs / options->count > 0 ? pairs / options->count : 1;
+    for (long i = 0; i < pairs; i++) {
+        int option = (int)((distinct ? i : i / run) % options->count);
+        char *value = args.storage + i * 12;
+        snprintf(value, 12, "%d", option);
+        args.argv[1 + 2 * i] = (char *)key_at(options, option);
+        args.argv[2 + 2 * i] = value;
+    }
+    return args;
+}
+
+static void free_argv(stress_argv_t *args) {
+    free(args->argv);
+    free(args->storage);
+}
+
+/* ---------------------------------------------------------------- checks */
+
+typedef struct {
+    const char *name;
+    const char *bound;
+    bool linear;             // cost proportional to the size, otherwise independent of it
+    long sizes[STEPS];
+    double ns[STEPS];        // fastest run at each size
+    double work[STEPS];      // counted lexer work of one run, 0 without PMARGP_STATS
+} stress_result_t;
+
+static int failures = 0;
+
+// Print the timings and judge the growth from n to 8n against the bound
+static void check_growth(const stress_result_t *result) {
+    double expected = result->linear ? (double)result->sizes[STEPS - 1] / (double)result->sizes[0] : 1.0;
+    bool ok = result->ns[0] < MIN_MEASURABLE_NS || result->ns[STEPS - 1] <= result->ns[0] * expected * GROWTH_LIMIT;
+    printf("%-28s %-18s", result->name, result->bound);
+    for (int i = 0; i < STEPS; i++) printf(" %9.2fms", result->ns[i] / 1e6);
+    if (result->work[0] > 0) {
+        double growth = result->work[STEPS - 1] / result->work[0];
+        printf("  %5.2fx work", growth);
+        if (growth > expected * WORK_LIMIT) ok = false;
+    }
+    printf("  %s\n", ok ? "ok" : "FAILED");
+    if (!ok) failures++;
+}
+
+#ifdef PMARGP_STATS
+// Tokens, lookups, key comparisons and conversions made so far
+static double counted_work(const struct pmargp_parser_t *parser) {
+    pmargp_stats_t stats;
+    pmargp_stats(parser, &stats);
+    double work = (double)(stats.tokens + stats.lookups + stats.key_compares);
+    for (int i = 0; i < PMARGP_TYPE_COUNT; i++) work += (double)stats.conversions[i];
+    return work;
+}
+
+// Hash lookups compare against the one key they land on, whatever the table size
+static void check_compares(const char *name, const struct pmargp_parser_t *parser) {
+    pmargp_stats_t stats;
+    pmargp_stats(parser, &stats);
+    double per_lookup = stats.lookups ? (double)stats.key_compares / (double)stats.lookups : 0.0;
+    bool ok = per_lookup <= 2.0;
+    printf("%-28s %-18s %.3f compares per lookup  %s\n", name, "O(1) compares", per_lookup,
+           ok ? "ok" : "FAILED");
+    if (!ok) failures++;
+}
+#endif
+
+/* -------------------------------------------------------------- workloads */
+
+typedef stress_options_t (*generator_t)(int count);
+
+static void stress_registration(const char *name, generator_t generate, int base) {
+    stress_result_t result = {name, "O(n)", true, {0}, {0}, {0}};
+    for (int step = 0; step < STEPS; step++) {
+        int count = base << step;
+        stress_options_t options = generate(count);
+        double best = 0;
+        for (int r = 0; r < REPETITIONS; r++) {
+            struct pmargp_parser_t parser;
+            parser_start(&parser);
+            double start = now_ns();
+            register_options(&parser, &options);
+            double elapsed = now_ns() - start;
+            free_parser(&parser);
+            if (r == 0 || elapsed < best) best = elapsed;
+        }
+        free_options(&options);
+        result.sizes[step] = count;
+        result.ns[step] = best;
+    }
+    check_growth(&result);
+}
+
+static void stress_parse(const char *name, generator_t generate, int count, long base, bool distinct) {
+    stress_result_t result = {name, "O(tokens)", true, {0}, {0}, {0}};
+    stress_options_t options = generate(count);
+    for (int step = 0; step < STEPS; step++) {
+        long tokens = base << step;
+        stress_argv_t args = make_argv(&options, tokens, distinct);
+        double best = 0;
+        for (int r = 0; r < REPETITIONS; r++) {
+            struct pmargp_parser_t parser;
+            parser_start(&parser);
+            register_options(&parser, &options);
+            double start = now_ns();
+            int error = parses(&parser, args.argc, args.argv);
+            double elapsed = now_ns() - start;
+            if (error != PMARGP_SUCCESS) {
+                fprintf(stderr, "stress: %s failed with %d\n", name, error);
+                exit(EXIT_FAILURE);
+            }
+#ifdef PMARGP_STATS
+            if (step == STEPS - 1 && r == 0) check_compares(name, &parser);
+            result.work[step] = counted_work(&parser);
+#endif
+            free_parser(&parser);
+            if (r == 0 || elapsed < best) best = elapsed;
+        }
+        free_argv(&args);
+        result.sizes[step] = tokens;
+        result.ns[step] = best;
+    }
+    free_options(&options);
+    check_growth(&result);
+}
+
+// The option count must not show up in the cost of a parse of fixed length.
+// A few tokens keep the per-token work small, so any pass over every option
+// made by each parse dominates; `parses_per_run` of them make it measurable.
+static void stress_table_size(const char *name, generator_t generate, int base, long tokens, int parses_per_run) {
+    stress_result_t result = {name, "O(1) in options", false, {0}, {0}, {0}};
+    for (int step = 0; step < STEPS; step++) {
+        int count = base << step;
+        stress_options_t options = generate(count);
+        stress_argv_t args = make_argv(&options, tokens, true);
+        double best = 0;
+        for (int r = 0; r < REPETITIONS; r++) {
+            struct pmargp_parser_t parser;
+            parser_start(&parser);
+            register_options(&parser, &options);
+            int error = PMARGP_SUCCESS;
+            double start = now_ns();
+            for (int p = 0; p < parses_per_run && error == PMARGP_SUCCESS; p++) {
+                error = parses(&parser, args.argc, args.argv);
+            }
+            double elapsed = now_ns() - start;
+#ifdef PMARGP_STATS
+            result.work[step] = counted_work(&parser);
+#endif
+            free_parser(&parser);
+            if (error != PMARGP_SUCCESS) {
+                fprintf(stderr, "stress: %s failed with %d\n", name, error);
+                exit(EXIT_FAILURE);
+            }
+            if (r == 0 || elapsed < best) best = elapsed;
+        }
+        free_argv(&args);
+        free_options(&options);
+        result.sizes[step] = count;
+        result.ns[step] = best;
+    }
+    check_growth(&result);
+}
+
+int main(void) {
+    printf("%-28s %-18s %11s %11s %11s %11s\n", "workload", "bound", "n", "2n", "4n", "8n");
+
+    stress_registration("register shared prefixes", shared_prefix_options, 12500);
+    stress_registration("register last-byte keys", last_byte_options, 12500);
+
+    stress_parse("parse shared prefixes", shared_prefix_options, 100000, 125000, true);
+    stress_parse("parse last-byte keys", last_byte_options, 100000, 125000, true);
+    stress_parse("parse repeated options", shared_prefix_options, 1000, 125000, false);
+
+    stress_table_size("4-token parse vs options", shared_prefix_options, 12500, 4, 20000);
+
+    if (failures) {
+        printf("%d workload(s) grew faster than their bound\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("all workloads within their bounds\n");
+    return EXIT_SUCCESS;
+}
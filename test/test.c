@@ -1,9 +1,14 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "pmargp.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
 #include <math.h>
+#include <regex.h>
+#include <limits.h>
+#include <stdint.h>
 
 typedef bool (*TestFunction)();
 
@@ -199,7 +204,7 @@ bool test_unrecognized_short_key() {
     char *argv[] = {"program", "-x", "value"};
     int argc = sizeof(argv) / sizeof(argv[0]);
 
-    int result = parser.parses(&parser, argc, argv) == PMARGP_ERR_ARG_MISSING;
+    int result = parser.parses(&parser, argc, argv) == PMARGP_ERR_INVALID_KEY;
     free_parser(&parser);
 
     return result; // Expect the result to be false due to unrecognized short key
@@ -302,6 +307,1369 @@ bool test_quoted_strings() {
     return result && correct_output;
 }
 
+// Test lookups and duplicate detection across enough keys to grow the index
+bool test_many_arguments() {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+
+    enum { COUNT = 2000 };
+    static int values[COUNT];
+    char key[32];
+    bool result = true;
+    for (int i = 0; i < COUNT; i++) {
+        snprintf(key, sizeof(key), "--option-%d", i);
+        result &= parser.add_argument(&parser, NULL, key, PMARGP_INT, &values[i], "Generated", false) == PMARGP_SUCCESS;
+    }
+    result &= parser.add_argument(&parser, "-x", "--extra", PMARGP_BOOL, NULL, "Extra", false) == PMARGP_SUCCESS;
+    result &= parser.add_argument(&parser, NULL, "--option-1999", PMARGP_INT, NULL, "Duplicate", false) == PMARGP_ERR_EXISTING_ARGUMENT;
+    result &= parser.add_argument(&parser, "-x", "--other", PMARGP_INT, NULL, "Duplicate short", false) == PMARGP_ERR_EXISTING_ARGUMENT;
+
+    for (int i = 0; i < COUNT && result; i++) {
+        snprintf(key, sizeof(key), "--option-%d", i);
+        result &= parser.get_argument_index(&parser, key) == i;
+    }
+    result &= parser.get_argument_index(&parser, "-x") == COUNT;
+    result &= parser.get_argument(&parser, "--extra") == &parser.args[COUNT];
+    result &= parser.get_argument(&parser, "--option-2000") == NULL;
+    result &= parser.get_argument(&parser, "--option-") == NULL;
+    result &= parser.get_argument(&parser, "-y") == NULL;
+
+    char *args[] = {"program", "--option-7", "7", "--option-1234", "1234"};
+    result &= PMARGP_SUCCESS == parser.parses(&parser, sizeof(args) / sizeof(args[0]), args);
+    result &= values[7] == 7 && values[1234] == 1234;
+
+    free_parser(&parser);
+    return result;
+}
+// Test that key validation accepts and rejects exactly what the original regexes did
+static bool regex_accepts(const regex_t *regex, const char *key) {
+    return regexec(regex, key, 0, NULL, 0) == 0;
+}
+
+static bool key_validation_agrees(const regex_t *large, const regex_t *small, const char *key) {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    bool large_ok = parser.add_argument(&parser, NULL, key, PMARGP_BOOL, NULL, NULL, false) != PMARGP_ERR_INVALID_KEY;
+    free_parser(&parser);
+
+    parser_start(&parser);
+    bool short_ok = parser.add_argument(&parser, key, NULL, PMARGP_BOOL, NULL, NULL, false) != PMARGP_ERR_INVALID_KEY;
+    free_parser(&parser);
+
+    bool agrees = large_ok == regex_accepts(large, key) && short_ok == regex_accepts(small, key);
+    if (!agrees) printf("key validation differs from regex for \"%s\"\n", key);
+    return agrees;
+}
+
+bool test_key_validation() {
+    regex_t large, small;
+    if (regcomp(&large, "^--[A-Za-z0-9]+([_-]?[A-Za-z0-9]+)*$", REG_EXTENDED)) return false;
+    if (regcomp(&small, "^-[A-Za-z]$", REG_EXTENDED)) {
+        regfree(&large);
+        return false;
+    }
+
+    bool result = true;
+    const char *samples[] = {
+        "", "-", "--", "---", "-a", "-Z", "-1", "-_", "-ab", "--a", "--A1", "--a-b", "--a_b",
+        "--a--b", "--a__b", "--a-_b", "--a-", "--a_", "--_a", "---a", "--a b", "--a.b",
+        "--output", "--out-put_file2", "--0", "a", "--\xc3\xa9", "-\xc3", "--a\n", "--ab\t",
+    };
+    for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        result &= key_validation_agrees(&large, &small, samples[i]);
+    }
+
+    // Exhaustively compare every key up to five characters over a small alphabet
+    const char alphabet[] = "-_aZ0. ";
+    const size_t symbols = sizeof(alphabet) - 1;
+    char key[6];
+    for (size_t len = 1; len <= 5 && result; len++) {
+        size_t total = 1;
+        for (size_t i = 0; i < len; i++) total *= symbols;
+        for (size_t n = 0; n < total && result; n++) {
+            size_t v = n;
+            for (size_t i = 0; i < len; i++, v /= symbols) key[i] = alphabet[v % symbols];
+            key[len] = '\0';
+            result &= key_validation_agrees(&large, &small, key);
+        }
+    }
+
+    regfree(&large);
+    regfree(&small);
+    return result;
+}
+// Test that a caller-supplied allocator backs the whole parser and is fully released
+typedef struct {
+    size_t allocations;
+    size_t frees;
+} counting_allocator_t;
+
+static void *counting_alloc(void *ctx, size_t size) {
+    ((counting_allocator_t *)ctx)->allocations++;
+    return malloc(size);
+}
+
+static void counting_free(void *ctx, void *ptr) {
+    ((counting_allocator_t *)ctx)->frees++;
+    free(ptr);
+}
+
+bool test_custom_allocator() {
+    counting_allocator_t counter = {0, 0};
+    pmargp_allocator_t allocator = {counting_alloc, counting_free, &counter};
+
+    struct pmargp_parser_t parser;
+    parser_start_with_allocator(&parser, &allocator);
+
+    enum { COUNT = 500 };
+    static int values[COUNT];
+    char key[32];
+    bool result = true;
+    for (int i = 0; i < COUNT; i++) {
+        snprintf(key, sizeof(key), "--option-%d", i);
+        result &= parser.add_argument(&parser, NULL, key, PMARGP_INT, &values[i], "A generated option with some help text", false) == PMARGP_SUCCESS;
+    }
+    result &= strcmp(parser.args[COUNT - 1].key, "--option-499") == 0;
+    result &= parser.get_argument_index(&parser, "--option-250") == 250;
+
+    // a few geometrically growing blocks instead of several mallocs per argument
+    result &= counter.allocations > 0 && counter.allocations < 16;
+
+    free_parser(&parser);
+    result &= counter.frees == counter.allocations;
+    result &= parser.args == NULL && parser.argc == 0;
+    return result;
+}
+// Test bulk registration from a static table, including its all-or-nothing behaviour
+bool test_bulk_registration() {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+
+    int count = 0;
+    float value = 0;
+    bool quiet = false;
+    char *name = NULL;
+    const pmargp_spec_t specs[] = {
+        {"-c", "--count", PMARGP_INT,    &count, "Number of greetings", PMARGP_FLAG_OPTIONAL},
+        {"-v", "--value", PMARGP_FLOAT,  &value, "A floating-point value", PMARGP_FLAG_OPTIONAL},
+        {NULL, "--quiet", PMARGP_BOOL,   &quiet, "Run in quiet mode", PMARGP_FLAG_OPTIONAL},
+        {"-n", NULL,      PMARGP_STRING, &name,  "Your name", PMARGP_FLAG_REQUIRED},
+    };
+    const size_t n = sizeof(specs) / sizeof(specs[0]);
+    bool result = pmargp_add_arguments(&parser, specs, n) == PMARGP_SUCCESS;
+    result &= parser.argc == (int)n && parser.capacity >= n;
+    result &= parser.args[3].required && !parser.args[0].required;
+
+    // Duplicate inside the batch, against the parser, and a bad key: nothing may be registered
+    const pmargp_spec_t inner_duplicate[] = {
+        {"-x", "--extra", PMARGP_BOOL, NULL, NULL, 0},
+        {"-y", "--extra", PMARGP_BOOL, NULL, NULL, 0},
+    };
+    const pmargp_spec_t outer_duplicate[] = {
+        {"-z", "--zeta", PMARGP_BOOL, NULL, NULL, 0},
+        {"-c", "--other", PMARGP_BOOL, NULL, NULL, 0},
+    };
+    const pmargp_spec_t invalid_key[] = {
+        {"-w", "--wide", PMARGP_BOOL, NULL, NULL, 0},
+        {NULL, "--bad key", PMARGP_BOOL, NULL, NULL, 0},
+    };
+    result &= pmargp_add_arguments(&parser, inner_duplicate, 2) == PMARGP_ERR_EXISTING_ARGUMENT;
+    result &= pmargp_add_arguments(&parser, outer_duplicate, 2) == PMARGP_ERR_EXISTING_ARGUMENT;
+    result &= pmargp_add_arguments(&parser, invalid_key, 2) == PMARGP_ERR_INVALID_KEY;
+    result &= parser.argc == (int)n;
+    result &= parser.get_argument(&parser, "--extra") == NULL && parser.get_argument(&parser, "-x") == NULL;
+    result &= parser.get_argument(&parser, "--zeta") == NULL && parser.get_argument(&parser, "-w") == NULL;
+
+    // The rejected batches left nothing behind, so they can be registered once fixed
+    result &= pmargp_add_arguments(&parser, inner_duplicate, 1) == PMARGP_SUCCESS;
+    result &= parser.get_argument_index(&parser, "-x") == (int)n;
+
+    char *args[] = {"program", "-n", "bee", "--count", "3", "--quiet"};
+    result &= PMARGP_SUCCESS == parser.parses(&parser, sizeof(args) / sizeof(args[0]), args);
+    result &= count == 3 && quiet && strcmp(name, "bee") == 0;
+
+    free_parser(&parser);
+    return result;
+}
+// Test that borrowed keys and descriptions are stored as the caller's pointers
+bool test_borrowed_strings() {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+
+    static const char key[] = "--borrowed";
+    static const char description[] = "Stored without a copy";
+    static const char copied_key[] = "--copied";
+    int a = 0, b = 0, c = 0;
+    const pmargp_spec_t specs[] = {
+        {"-b", key, PMARGP_INT, &a, description, PMARGP_FLAG_BORROWED | PMARGP_FLAG_REQUIRED},
+        {NULL, copied_key, PMARGP_INT, &b, description, PMARGP_FLAG_OPTIONAL},
+    };
+    bool result = pmargp_add_arguments(&parser, specs, 2) == PMARGP_SUCCESS;
+    result &= parser.args[0].key == key && parser.args[0].description == description;
+    result &= parser.args[0].required;
+    result &= parser.args[1].key != copied_key && strcmp(parser.args[1].key, copied_key) == 0;
+
+    // Positional names and descriptions follow the same flag
+    static const char input[] = "input", output[] = "output";
+    int d = 0, e = 0, f = 0;
+    result &= pmargp_add_positional(&parser, input, PMARGP_INT, &d, description, PMARGP_FLAG_BORROWED) == PMARGP_SUCCESS;
+    result &= pmargp_add_positional(&parser, output, PMARGP_INT, &e, description, PMARGP_FLAG_OPTIONAL) == PMARGP_SUCCESS;
+    result &= parser.args[2].name == input && parser.args[2].description == description;
+    result &= parser.args[3].name != output && strcmp(parser.args[3].name, output) == 0;
+    result &= parser.args[3].description != description;
+
+    // Parser-wide borrowing covers add_argument and positionals as well
+    static const char parser_key[] = "--parser-wide", last[] = "last";
+    parser.flags |= PMARGP_FLAG_BORROWED;
+    result &= parser.add_argument(&parser, NULL, parser_key, PMARGP_INT, &c, NULL, false) == PMARGP_SUCCESS;
+    result &= pmargp_add_positional(&parser, last, PMARGP_INT, &f, NULL, PMARGP_FLAG_OPTIONAL) == PMARGP_SUCCESS;
+    result &= parser.args[4].key == parser_key && parser.args[5].name == last;
+
+    char *args[] = {"program", "-b", "1", "--copied", "2", "--parser-wide", "3", "4", "5", "6"};
+    result &= PMARGP_SUCCESS == parser.parses(&parser, sizeof(args) / sizeof(args[0]), args);
+    result &= a == 1 && b == 2 && c == 3 && d == 4 && e == 5 && f == 6;
+
+    free_parser(&parser);
+    return result;
+}
+
+static int parse_value(pmargp_type_t type, void *value, const char *text) {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    parser.add_argument(&parser, NULL, "--value", type, value, NULL, false);
+    char *args[] = {"program", "--value", (char *)text};
+    int error = parser.parses(&parser, 3, args);
+    free_parser(&parser);
+    return error;
+}
+
+bool test_integer_types() {
+    int i = 0;
+    int64_t i64 = 0;
+    uint64_t u64 = 0;
+    size_t size = 0;
+    bool result = true;
+
+    // PMARGP_INT no longer truncates values that fit a long but not an int
+    result &= parse_value(PMARGP_INT, &i, "2147483647") == PMARGP_SUCCESS && i == INT_MAX;
+    result &= parse_value(PMARGP_INT, &i, "-2147483648") == PMARGP_SUCCESS && i == INT_MIN;
+    result &= parse_value(PMARGP_INT, &i, "2147483648") == PMARGP_ERR_INVALID_VALUE;
+    result &= parse_value(PMARGP_INT, &i, "-2147483649") == PMARGP_ERR_INVALID_VALUE;
+
+    result &= parse_value(PMARGP_INT64, &i64, "9223372036854775807") == PMARGP_SUCCESS && i64 == INT64_MAX;
+    result &= parse_value(PMARGP_INT64, &i64, "-9223372036854775808") == PMARGP_SUCCESS && i64 == INT64_MIN;
+    result &= parse_value(PMARGP_INT64, &i64, "-0000000000000000000000042") == PMARGP_SUCCESS && i64 == -42;
+    result &= parse_value(PMARGP_INT64, &i64, "9223372036854775808") == PMARGP_ERR_INVALID_VALUE;
+    result &= parse_value(PMARGP_INT64, &i64, "-9223372036854775809") == PMARGP_ERR_INVALID_VALUE;
+
+    result &= parse_value(PMARGP_UINT64, &u64, "18446744073709551615") == PMARGP_SUCCESS && u64 == UINT64_MAX;
+    result &= parse_value(PMARGP_UINT64, &u64, "12345678901234567") == PMARGP_SUCCESS && u64 == 12345678901234567ULL;
+    result &= parse_value(PMARGP_UINT64, &u64, "18446744073709551616") == PMARGP_ERR_INVALID_VALUE;
+    result &= parse_value(PMARGP_UINT64, &u64, "28446744073709551615") == PMARGP_ERR_INVALID_VALUE;
+    result &= parse_value(PMARGP_UINT64, &u64, "100000000000000000000") == PMARGP_ERR_INVALID_VALUE;
+    result &= parse_value(PMARGP_UINT64, &u64, "-1") == PMARGP_ERR_INVALID_VALUE;
+
+    result &= parse_value(PMARGP_SIZE, &size, "4096") == PMARGP_SUCCESS && size == 4096;
+    result &= parse_value(PMARGP_SIZE, &size, "") == PMARGP_ERR_INVALID_VALUE;
+    result &= parse_value(PMARGP_SIZE, &size, "+") == PMARGP_ERR_INVALID_VALUE;
+    result &= parse_value(PMARGP_SIZE, &size, "12ab") == PMARGP_ERR_INVALID_VALUE;
+    result &= parse_value(PMARGP_SIZE, &size, "0x10") == PMARGP_ERR_INVALID_VALUE;
+    return result;
+}
+
+static uint64_t next_random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static bool has_nonzero_mantissa(const char *text) {
+    for (; *text && *text != 'e' && *text != 'E'; text++) {
+        if (*text >= '1' && *text <= '9') return true;
+    }
+    return false;
+}
+
+// Parse text both ways and compare the bits; inputs strtod would overflow or
+// flush to zero must be rejected instead.
+static bool double_agrees(const char *text) {
+    double expected = strtod(text, NULL), actual = 0;
+    int error = parse_value(PMARGP_DOUBLE, &actual, text);
+    if (isinf(expected) || (expected == 0 && has_nonzero_mantissa(text))) {
+        return error == PMARGP_ERR_INVALID_VALUE;
+    }
+    if (error != PMARGP_SUCCESS || memcmp(&expected, &actual, sizeof(double)) != 0) {
+        printf("\n  double mismatch for %s: %.17g vs %.17g\n", text, expected, actual);
+        return false;
+    }
+    return true;
+}
+
+static bool float_agrees(const char *text) {
+    float expected = strtof(text, NULL), actual = 0;
+    int error = parse_value(PMARGP_FLOAT, &actual, text);
+    if (isinf(expected) || (expected == 0 && has_nonzero_mantissa(text))) {
+        return error == PMARGP_ERR_INVALID_VALUE;
+    }
+    if (error != PMARGP_SUCCESS || memcmp(&expected, &actual, sizeof(float)) != 0) {
+        printf("\n  float mismatch for %s: %.9g vs %.9g\n", text, expected, actual);
+        return false;
+    }
+    return true;
+}
+
+bool test_float_conformance() {
+    static const char *cases[] = {
+        "0", "-0", "0.0", "1", "-1", ".5", "5.", "3.14159", "1e10", "1E-10", "+2.5e+3",
+        "9007199254740993", "9007199254740995", "2.2250738585072011e-308", "2.2250738585072014e-308",
+        "4.9406564584124654e-324", "2.4703282292062328e-324", "1.7976931348623157e308",
+        "1.7976931348623159e308", "1e-400", "1e400", "123456789012345678901234567890",
+        "0.1000000000000000055511151231257827021181583404541015625",
+        "0.1000000000000000055511151231257827021181583404541015624",
+        "0.1000000000000000055511151231257827021181583404541015626",
+        "7.038531e-26", "3.4028235e38", "3.4028236e38", "1.17549435e-38", "1.4e-45",
+        "0.000000000000000000000000000000000000000000000000000000000000000001",
+        // inexact subnormals past 19 digits, where strtod reports ERANGE
+        "351118672.61250670766652e-317", "1.1754942106924410754870294448492873e-38",
+    };
+    bool result = true;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        result &= double_agrees(cases[i]);
+        result &= float_agrees(cases[i]);
+    }
+
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    char text[96];
+    for (int i = 0; i < 20000 && result; i++) {
+        // Every bit pattern printed at a random precision
+        uint64_t bits = next_random(&state);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        if (!isfinite(value)) continue;
+        snprintf(text, sizeof(text), "%.*g", (int)(bits % 17) + 1, value);
+        result &= double_agrees(text);
+        uint32_t word = (uint32_t)(bits >> 32);
+        float single;
+        memcpy(&single, &word, sizeof(single));
+        if (!isfinite(single)) continue;
+        snprintf(text, sizeof(text), "%.*g", (int)(bits % 9) + 1, single);
+        result &= float_agrees(text);
+
+        // Random digit strings, including mantissas longer than 19 digits
+        uint64_t r = next_random(&state);
+        int digits = (int)(r % 40) + 1, point = (int)((r >> 8) % (uint64_t)(digits + 1));
+        int exponent = (int)((r >> 16) % 700) - 350;
+        char *out = text;
+        for (int d = 0; d < digits; d++) {
+            if (d == point) *out++ = '.';
+            *out++ = (char)('0' + (next_random(&state) % 10));
+        }
+        snprintf(out, sizeof(text) - (size_t)(out - text), "e%d", exponent);
+        result &= double_agrees(text);
+        snprintf(out, sizeof(text) - (size_t)(out - text), "e%d", exponent / 8);
+        result &= float_agrees(text);
+    }
+
+    // Halfway cases whose deciding digit sits past the digits strtod is given
+    static char halfway[1200];
+    const char *heads[] = {"9007199254740993.", "0x1.00000000000008", "0x1.000001"};
+    for (size_t i = 0; i < sizeof(heads) / sizeof(heads[0]); i++) {
+        size_t n = strlen(heads[i]);
+        memcpy(halfway, heads[i], n);
+        memset(halfway + n, '0', 1000);
+        halfway[n + 1000] = '\0';
+        result &= double_agrees(halfway) && float_agrees(halfway);
+        halfway[n + 999] = '1';
+        result &= double_agrees(halfway) && float_agrees(halfway);
+    }
+
+    double value = 0;
+    result &= parse_value(PMARGP_DOUBLE, &value, "inf") == PMARGP_SUCCESS && isinf(value) && value > 0;
+    result &= parse_value(PMARGP_DOUBLE, &value, "-Infinity") == PMARGP_SUCCESS && isinf(value) && value < 0;
+    result &= parse_value(PMARGP_DOUBLE, &value, "nan") == PMARGP_SUCCESS && isnan(value);
+    result &= parse_value(PMARGP_DOUBLE, &value, "0x1.8p1") == PMARGP_SUCCESS && value == 3.0;
+    result &= parse_value(PMARGP_DOUBLE, &value, "-0x.Cp-1") == PMARGP_SUCCESS && value == -0.375;
+    result &= parse_value(PMARGP_DOUBLE, &value, "0x") == PMARGP_ERR_INVALID_VALUE;
+    result &= parse_value(PMARGP_DOUBLE, &value, "0x1p") == PMARGP_ERR_INVALID_VALUE;
+    result &= parse_value(PMARGP_DOUBLE, &value, "0x1p99999") == PMARGP_ERR_INVALID_VALUE;
+    result &= parse_value(PMARGP_DOUBLE, &value, "1.5.2") == PMARGP_ERR_INVALID_VALUE;
+    result &= parse_value(PMARGP_DOUBLE, &value, "1e") == PMARGP_ERR_INVALID_VALUE;
+    result &= parse_value(PMARGP_DOUBLE, &value, ".") == PMARGP_ERR_INVALID_VALUE;
+    result &= parse_value(PMARGP_DOUBLE, &value, "1,5") == PMARGP_ERR_INVALID_VALUE;
+    return result;
+}
+
+bool test_lazy_files() {
+    const char *path = "/tmp/pmargp_lazy_test.txt";
+    FILE *seed = fopen(path, "w");
+    if (!seed) return false;
+    fputs("keep", seed);
+    fclose(seed);
+
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    FILE *output = NULL, *input = NULL, *missing = NULL;
+    const pmargp_spec_t specs[] = {
+        {"-o", "--output", PMARGP_W_FILE, &output, NULL, PMARGP_FLAG_LAZY},
+        {"-i", "--input", PMARGP_R_FILE, &input, NULL, PMARGP_FLAG_LAZY},
+        {"-m", "--missing", PMARGP_R_FILE, &missing, NULL, PMARGP_FLAG_LAZY},
+    };
+    bool result = pmargp_add_arguments(&parser, specs, 3) == PMARGP_SUCCESS;
+
+    char *args[] = {"program", "-o", (char *)path, "-i", "/dev/null", "-m", "/nonexistent/dir/file"};
+    result &= PMARGP_SUCCESS == parser.parses(&parser, sizeof(args) / sizeof(args[0]), args);
+    result &= output == NULL && input == NULL && missing == NULL;
+
+    // Nothing was opened, so the output file has not been truncated yet
+    char content[8] = {0};
+    FILE *check = fopen(path, "r");
+    result &= check && fgets(content, sizeof(content), check) && strcmp(content, "keep") == 0;
+    if (check) fclose(check);
+
+    FILE *file = NULL;
+    result &= pmargp_open_file(&parser, "--input", &file) == PMARGP_SUCCESS && file && file == input;
+    result &= pmargp_open_file(&parser, "-i", &file) == PMARGP_SUCCESS && file == input;
+    result &= pmargp_open_file(&parser, "--missing", &file) == PMARGP_ERR_FILE_OPEN && missing == NULL;
+    result &= pmargp_open_file(&parser, "--unknown", &file) == PMARGP_ERR_INVALID_KEY;
+    result &= pmargp_open_files(&parser) == PMARGP_ERR_FILE_OPEN && output != NULL;
+
+    free_parser(&parser);
+    result &= output == NULL && input == NULL;
+    remove(path);
+    return result;
+}
+
+bool test_mmap_file() {
+    const char *path = "/tmp/pmargp_mmap_test.txt", *empty_path = "/tmp/pmargp_mmap_empty.txt";
+    FILE *seed = fopen(path, "w"), *empty_seed = fopen(empty_path, "w");
+    if (!seed || !empty_seed) return false;
+    fputs("According to all known laws of aviation", seed);
+    fclose(seed);
+    fclose(empty_seed);
+
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    pmargp_mmap_t input = {NULL, 0, PMARGP_MADV_SEQUENTIAL | PMARGP_MADV_WILLNEED | PMARGP_MADV_HUGEPAGE};
+    pmargp_mmap_t empty = {NULL, 0, PMARGP_MADV_NORMAL};
+    parser.add_argument(&parser, "-i", "--input", PMARGP_MMAP_FILE, &input, "Input file", true);
+    parser.add_argument(&parser, "-e", "--empty", PMARGP_MMAP_FILE, &empty, "Empty file", false);
+
+    char *args[] = {"program", "-i", (char *)path, "--empty", (char *)empty_path};
+    bool result = PMARGP_SUCCESS == parser.parses(&parser, sizeof(args) / sizeof(args[0]), args);
+    result &= input.data != NULL && input.size == strlen("According to all known laws of aviation");
+    result &= input.data && memcmp(input.data, "According", 9) == 0;
+    result &= empty.data != NULL && empty.size == 0;
+    free_parser(&parser);
+    result &= input.data == NULL && input.size == 0;
+
+    // Missing files and directories come back as PMARGP_ERR_FILE_OPEN
+    parser_start(&parser);
+    parser.add_argument(&parser, "-i", "--input", PMARGP_MMAP_FILE, &input, "Input file", true);
+    char *missing[] = {"program", "-i", "/nonexistent/dir/file"};
+    char *directory[] = {"program", "-i", "/tmp"};
+    result &= PMARGP_ERR_FILE_OPEN == parser.parses(&parser, 3, missing);
+    result &= PMARGP_ERR_FILE_OPEN == parser.parses(&parser, 3, directory);
+    result &= input.data == NULL;
+    free_parser(&parser);
+
+    remove(path);
+    remove(empty_path);
+    return result;
+}
+
+static bool write_file(const char *path, const char *content) {
+    FILE *file = fopen(path, "w");
+    if (!file) return false;
+    fputs(content, file);
+    fclose(file);
+    return true;
+}
+
+bool test_response_files() {
+    const char *outer = "/tmp/pmargp_response_outer.txt", *inner = "/tmp/pmargp_response_inner.txt";
+    const char *loop = "/tmp/pmargp_response_loop.txt";
+    bool result = write_file(outer, "--name 'Barry B. Benson'\n\t--count 3 @/tmp/pmargp_response_inner.txt\n");
+    result &= write_file(inner, "--title \"say \\\"ya like jazz?\\\"\" --path C:\\\\bees\\ hive --quiet --last end");
+    result &= write_file(loop, "@/tmp/pmargp_response_loop.txt");
+
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    char *name = NULL, *title = NULL, *path = NULL, *last = NULL;
+    int count = 0;
+    bool quiet = false;
+    parser.add_argument(&parser, "-n", "--name", PMARGP_STRING, &name, NULL, true);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, false);
+    parser.add_argument(&parser, "-t", "--title", PMARGP_STRING, &title, NULL, false);
+    parser.add_argument(&parser, "-p", "--path", PMARGP_STRING, &path, NULL, false);
+    parser.add_argument(&parser, "-q", "--quiet", PMARGP_BOOL, &quiet, NULL, false);
+    parser.add_argument(&parser, "-l", "--last", PMARGP_STRING, &last, NULL, false);
+
+    char *args[] = {"program", "@/tmp/pmargp_response_outer.txt", "@"};
+    result &= PMARGP_SUCCESS == parser.parses(&parser, sizeof(args) / sizeof(args[0]), args);
+    result &= name && strcmp(name, "Barry B. Benson") == 0 && count == 3 && quiet;
+    result &= title && strcmp(title, "say \"ya like jazz?\"") == 0;
+    result &= path && strcmp(path, "C:\\bees hive") == 0;
+    result &= last && strcmp(last, "end") == 0;
+    free_parser(&parser);
+
+    // Self-inclusion stops at the depth limit, unreadable paths stay literal
+    parser_start(&parser);
+    parser.add_argument(&parser, "-n", "--name", PMARGP_STRING, &name, NULL, false);
+    char *looping[] = {"program", "@/tmp/pmargp_response_loop.txt"};
+    char *literal[] = {"program", "--name", "@handle", "@/nonexistent/dir/file"};
+    result &= PMARGP_ERR_RESPONSE_DEPTH == parser.parses(&parser, 2, looping);
+    result &= PMARGP_SUCCESS == parser.parses(&parser, 4, literal) && strcmp(name, "@handle") == 0;
+
+    // Later parses reuse the expanded argv instead of growing the arena
+    char **expansion = parser.expansion;
+    result &= expansion && PMARGP_SUCCESS == parser.parses(&parser, 4, literal) && parser.expansion == expansion;
+    free_parser(&parser);
+
+    // A string from a response file outlives later parses until free_parser
+    const char *named = "/tmp/pmargp_response_named.txt";
+    result &= write_file(named, "--name fromfile --count 2");
+    parser_start(&parser);
+    name = NULL;
+    parser.add_argument(&parser, "-n", "--name", PMARGP_STRING, &name, NULL, false);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, false);
+    char *from_file[] = {"program", "@/tmp/pmargp_response_named.txt"};
+    char *plain[] = {"program", "--count", "3"};
+    result &= PMARGP_SUCCESS == parser.parses(&parser, 2, from_file);
+    result &= PMARGP_SUCCESS == parser.parses(&parser, 3, plain);
+    result &= name && strcmp(name, "fromfile") == 0 && count == 2;
+    free_parser(&parser);
+    remove(named);
+
+    remove(outer);
+    remove(inner);
+    remove(loop);
+    return result;
+}
+
+bool test_streaming_parse() {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    char *name = NULL;
+    int count = 0;
+    double value = 0;
+    bool quiet = false;
+    parser.add_argument(&parser, "-n", "--name", PMARGP_STRING, &name, NULL, true);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, true);
+    parser.add_argument(&parser, "-v", "--value", PMARGP_DOUBLE, &value, NULL, false);
+    parser.add_argument(&parser, "-q", "--quiet", PMARGP_BOOL, &quiet, NULL, false);
+
+    // Tokens arrive unterminated in a scratch buffer that is reused for the next one
+    const char *stream = "--name|Barry|-q|-c|42|--value|0.25|operand";
+    char scratch[16];
+    bool result = pmargp_begin(&parser) == PMARGP_SUCCESS;
+    for (const char *p = stream; *p;) {
+        size_t len = strcspn(p, "|");
+        memcpy(scratch, p, len);
+        memset(scratch + len, 'x', sizeof(scratch) - len);
+        result &= pmargp_feed(&parser, scratch, len) == PMARGP_SUCCESS;
+        p += len + (p[len] == '|');
+    }
+    result &= pmargp_finish(&parser) == PMARGP_SUCCESS;
+    result &= name && strcmp(name, "Barry") == 0 && count == 42 && value == 0.25 && quiet;
+    free_parser(&parser);
+
+    parser_start(&parser);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, true);
+    result &= pmargp_begin(&parser) == PMARGP_SUCCESS;
+    result &= pmargp_feed(&parser, "-c", 2) == PMARGP_SUCCESS;
+    result &= pmargp_feed(&parser, "12x", 3) == PMARGP_ERR_INVALID_VALUE;
+    result &= pmargp_feed(&parser, "--count", 7) == PMARGP_SUCCESS;
+    result &= pmargp_finish(&parser) == PMARGP_ERR_ARG_MISSING;
+    result &= pmargp_feed(&parser, "--unknown", 9) == PMARGP_ERR_INVALID_KEY;
+    free_parser(&parser);
+    return result;
+}
+
+bool test_parse_string() {
+    counting_allocator_t counter = {0, 0};
+    pmargp_allocator_t allocator = {counting_alloc, counting_free, &counter};
+    struct pmargp_parser_t parser;
+    parser_start_with_allocator(&parser, &allocator);
+    char *name = NULL, *motto = NULL, *path = NULL, *empty = NULL;
+    int count = 0;
+    bool quiet = false;
+    parser.add_argument(&parser, "-n", "--name", PMARGP_STRING, &name, NULL, true);
+    parser.add_argument(&parser, "-m", "--motto", PMARGP_STRING, &motto, NULL, false);
+    parser.add_argument(&parser, "-p", "--path", PMARGP_STRING, &path, NULL, false);
+    parser.add_argument(&parser, "-e", "--empty", PMARGP_STRING, &empty, NULL, false);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, false);
+    parser.add_argument(&parser, "-q", "--quiet", PMARGP_BOOL, &quiet, NULL, false);
+    size_t allocations = counter.allocations;
+
+    char buf[] = "  --name 'Barry B.'\"\\\"Benson\\\"\" -c \\\n 7 --motto \"\\$ and \\a\""
+                 " --path my\\ hive/'it''s' -e '' -q";
+    bool result = PMARGP_SUCCESS == pmargp_parse_string(&parser, buf, strlen(buf));
+    result &= name && strcmp(name, "Barry B.\"Benson\"") == 0;
+    result &= motto && strcmp(motto, "$ and \\a") == 0;
+    result &= path && strcmp(path, "my hive/its") == 0;
+    result &= empty && strcmp(empty, "") == 0;
+    result &= count == 7 && quiet;
+
+    // Values point into the caller's buffer and nothing was allocated
+    result &= name >= buf && name < buf + sizeof(buf) && path >= buf && path < buf + sizeof(buf);
+    result &= counter.allocations == allocations;
+    free_parser(&parser);
+
+    parser_start(&parser);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, true);
+    char invalid[] = "--count 'seven'";
+    char missing[] = "  ";
+    result &= PMARGP_ERR_INVALID_VALUE == pmargp_parse_string(&parser, invalid, strlen(invalid));
+    result &= PMARGP_ERR_ARG_MISSING == pmargp_parse_string(&parser, missing, strlen(missing));
+    free_parser(&parser);
+
+    // A quote left open is an error, in a string, a response file or a config file
+    const char *response = "/tmp/pmargp_unterminated.rsp", *config = "/tmp/pmargp_unterminated.ini";
+    result &= write_file(response, "--name \"unterminated value\n");
+    result &= write_file(config, "name = 'unterminated value\n");
+    parser_start(&parser);
+    name = NULL;
+    parser.add_argument(&parser, "-n", "--name", PMARGP_STRING, &name, NULL, false);
+    char unterminated[] = "--name \"unterminated value";
+    char *response_argv[] = {"program", "@/tmp/pmargp_unterminated.rsp"};
+    result &= PMARGP_ERR_INVALID_VALUE == pmargp_parse_string(&parser, unterminated, strlen(unterminated));
+    result &= PMARGP_ERR_INVALID_VALUE == parses(&parser, 2, response_argv) && name == NULL;
+    pmargp_set_config_file(&parser, config);
+    result &= PMARGP_ERR_INVALID_VALUE == parses(&parser, 1, response_argv) && name == NULL;
+    free_parser(&parser);
+    remove(response);
+    remove(config);
+    return result;
+}
+
+bool test_frozen_contexts() {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    char *name = NULL;
+    int count = 1;
+    bool quiet = false;
+    parser.add_argument(&parser, "-n", "--name", PMARGP_STRING, &name, NULL, true);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, false);
+    parser.add_argument(&parser, "-q", "--quiet", PMARGP_BOOL, &quiet, NULL, false);
+
+    pmargp_context_t a, b;
+    bool result = pmargp_context_init(&a, &parser) == PMARGP_ERR_NOT_FROZEN;
+    result &= pmargp_freeze(&parser) == PMARGP_SUCCESS;
+    result &= parser.add_argument(&parser, "-x", NULL, PMARGP_INT, &count, NULL, false) == PMARGP_ERR_FROZEN;
+    result &= pmargp_context_init(&a, &parser) == PMARGP_SUCCESS;
+    result &= pmargp_context_init(&b, &parser) == PMARGP_SUCCESS;
+
+    // Two contexts against one parser, each reused for several parses
+    char *first[] = {"program", "--name", "Barry", "-c", "3", "-q"};
+    char *second[] = {"program", "-n", "Vanessa"};
+    for (int round = 0; round < 3; round++) {
+        result &= pmargp_parse_context(&a, 6, first) == PMARGP_SUCCESS;
+        result &= pmargp_parse_context(&b, 3, second) == PMARGP_SUCCESS;
+        result &= strcmp(pmargp_context_get(&a, "--name")->s, "Barry") == 0;
+        result &= pmargp_context_get(&a, "-c")->i == 3 && pmargp_context_get(&a, "--quiet")->b;
+        result &= strcmp(pmargp_context_get(&b, "-n")->s, "Vanessa") == 0;
+        result &= !pmargp_context_has(&b, "--count") && !pmargp_context_has(&b, "-q");
+        result &= !pmargp_context_has(&b, "--unknown");
+    }
+
+    // The parser and the variables registered with it are never written
+    result &= name == NULL && count == 1 && !quiet && !parser.args[0].allocated;
+    result &= parses(&parser, 6, first) == PMARGP_ERR_FROZEN;
+
+    char *invalid[] = {"program", "-n", "Barry", "--count", "many"};
+    char *missing[] = {"program", "-q"};
+    char *help[] = {"program", "-c", "many", "--help"};
+    result &= pmargp_parse_context(&a, 5, invalid) == PMARGP_ERR_INVALID_VALUE;
+    result &= a.error == PMARGP_ERR_INVALID_VALUE && a.error_index == 1 && strcmp(a.error_token, "many") == 0;
+    result &= pmargp_parse_context(&a, 2, missing) == PMARGP_ERR_ARG_MISSING && a.error_index == 0;
+    result &= pmargp_parse_context(&a, 4, help) == PMARGP_SUCCESS && a.help;
+    result &= pmargp_parse_context(&a, 3, second) == PMARGP_SUCCESS && !a.help && !pmargp_context_has(&a, "-q");
+
+    pmargp_context_free(&a);
+    pmargp_context_free(&b);
+    free_parser(&parser);
+    return result;
+}
+
+bool test_format_help() {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    parser.name = "bee";
+    parser.description = "Bee things.";
+    parser.flags |= PMARGP_FLAG_NO_EXIT;
+    char *name = "Barry";
+    char *none = NULL;
+    int count = 3;
+    char grade = 'A';
+    parser.add_argument(&parser, "-n", "--name", PMARGP_STRING, &name, "Your name", true);
+    parser.add_argument(&parser, NULL, "--none", PMARGP_STRING, &none, NULL, false);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, "Count", false);
+    parser.add_argument(&parser, "-g", NULL, PMARGP_CHAR, &grade, "Grade", false);
+
+    const char *expected =
+        "\nbee\nBee things.\n\nusage: bee [OPTIONS] \n\nOptions:\n"
+        "  --name     -n  <string>       Your name (Type: string) [Default: Barry] [Required] \n"
+        "  --none         <string>       No description (Type: string) [Default: None]\n"
+        "  --count    -c  <integer>      Count (Type: int) [Default: 3]\n"
+        "             -g  <char>         Grade (Type: char) [Default: A]\n"
+        "\n";
+    char buf[1024];
+    size_t len = pmargp_format_help(&parser, buf, sizeof(buf));
+    bool result = len == strlen(expected) && strcmp(buf, expected) == 0;
+
+    // Truncated output keeps snprintf semantics
+    char small[16];
+    result &= pmargp_format_help(&parser, small, sizeof(small)) == len;
+    result &= strlen(small) == sizeof(small) - 1 && strncmp(small, expected, sizeof(small) - 1) == 0;
+    result &= pmargp_format_help(&parser, NULL, 0) == len;
+
+    // With PMARGP_FLAG_NO_EXIT help is a return code instead of exit()
+    char *argv[] = {"program", "--count", "4", "--help"};
+    char command[] = "-h";
+    result &= parses(&parser, 4, argv) == PMARGP_HELP_REQUESTED;
+    result &= pmargp_parse_string(&parser, command, strlen(command)) == PMARGP_HELP_REQUESTED;
+    pmargp_begin(&parser);
+    result &= pmargp_feed(&parser, "--help", 6) == PMARGP_HELP_REQUESTED;
+    free_parser(&parser);
+    return result;
+}
+
+bool test_layered_sources() {
+    const char *config = "/tmp/pmargp_config.ini";
+    bool result = write_file(config,
+        "# service defaults\n"
+        "name = Barry B. Benson\n"
+        "\n"
+        "  count=1\n"
+        "; shadowed by the environment\n"
+        "max-depth = 4\n"
+        "--title = \"say \\\"ya like jazz?\\\"\"\n"
+        "unknown = ignored\n"
+        "quiet = yes\n"
+        "-r = z");
+
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    char *name = NULL, *title = NULL;
+    int count = 0, depth = 0;
+    bool quiet = false;
+    char grade = 'A', letter = 'a';
+    parser.add_argument(&parser, "-n", "--name", PMARGP_STRING, &name, NULL, true);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, false);
+    parser.add_argument(&parser, NULL, "--max-depth", PMARGP_INT, &depth, NULL, false);
+    parser.add_argument(&parser, "-t", "--title", PMARGP_STRING, &title, NULL, false);
+    parser.add_argument(&parser, "-q", "--quiet", PMARGP_BOOL, &quiet, NULL, false);
+    parser.add_argument(&parser, "-g", "--grade", PMARGP_CHAR, &grade, NULL, false);
+    parser.add_argument(&parser, "-r", NULL, PMARGP_CHAR, &letter, NULL, false);
+    result &= pmargp_bind_env(&parser, "--grade", "PMARGP_TEST_LETTER") == PMARGP_SUCCESS;
+    result &= pmargp_bind_env(&parser, "--unknown", "PMARGP_TEST_X") == PMARGP_ERR_INVALID_KEY;
+    result &= pmargp_bind_env_prefix(&parser, "PMARGP_TEST_") == PMARGP_SUCCESS;
+    result &= strcmp(get_argument(&parser, "--max-depth")->env, "PMARGP_TEST_MAX_DEPTH") == 0;
+    result &= strcmp(get_argument(&parser, "-g")->env, "PMARGP_TEST_LETTER") == 0;
+    result &= get_argument(&parser, "-r")->env == NULL;
+    result &= pmargp_set_config_file(&parser, config) == PMARGP_SUCCESS;
+
+    // argv over the environment over the config file over the defaults
+    setenv("PMARGP_TEST_MAX_DEPTH", "8", 1);
+    setenv("PMARGP_TEST_COUNT", "2", 1);
+    setenv("PMARGP_TEST_LETTER", "B", 1);
+    char *argv[] = {"program", "--count", "3"};
+    result &= parses(&parser, 3, argv) == PMARGP_SUCCESS;
+    result &= count == 3 && depth == 8 && grade == 'B' && letter == 'z' && quiet;
+    result &= strcmp(name, "Barry B. Benson") == 0 && strcmp(title, "say \"ya like jazz?\"") == 0;
+    result &= get_argument(&parser, "-c")->source == PMARGP_SOURCE_ARGV;
+    result &= get_argument(&parser, "--max-depth")->source == PMARGP_SOURCE_ENV;
+    result &= get_argument(&parser, "-n")->source == PMARGP_SOURCE_CONFIG;
+
+    // Config strings outlive a later parse that no longer reads the file
+    result &= pmargp_set_config_file(&parser, NULL) == PMARGP_SUCCESS;
+    result &= parses(&parser, 3, argv) == PMARGP_SUCCESS;
+    result &= strcmp(name, "Barry B. Benson") == 0 && strcmp(title, "say \"ya like jazz?\"") == 0;
+    free_parser(&parser);
+
+    // The same merge through a context, which records sources per parse
+    parser_start(&parser);
+    parser.add_argument(&parser, "-n", "--name", PMARGP_STRING, &name, NULL, true);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, false);
+    parser.add_argument(&parser, "-q", "--quiet", PMARGP_BOOL, &quiet, NULL, false);
+    pmargp_bind_env_prefix(&parser, "PMARGP_TEST_");
+    pmargp_set_config_file(&parser, config);
+    pmargp_freeze(&parser);
+    result &= pmargp_set_config_file(&parser, NULL) == PMARGP_ERR_FROZEN;
+    pmargp_context_t ctx;
+    pmargp_context_init(&ctx, &parser);
+    char *bare[] = {"program"};
+    setenv("PMARGP_TEST_QUIET", "off", 1);
+    result &= pmargp_parse_context(&ctx, 1, bare) == PMARGP_SUCCESS;
+    result &= pmargp_context_get(&ctx, "-c")->i == 2 && !pmargp_context_get(&ctx, "-q")->b;
+    result &= pmargp_context_source(&ctx, "--count") == PMARGP_SOURCE_ENV;
+    result &= pmargp_context_source(&ctx, "--name") == PMARGP_SOURCE_CONFIG;
+
+    // A bad value is reported against the argument, whatever its source
+    setenv("PMARGP_TEST_QUIET", "maybe", 1);
+    result &= pmargp_parse_context(&ctx, 1, bare) == PMARGP_ERR_INVALID_VALUE && ctx.error_index == 2;
+    pmargp_context_free(&ctx);
+    free_parser(&parser);
+
+    parser_start(&parser);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, false);
+    pmargp_set_config_file(&parser, "/nonexistent/pmargp.ini");
+    result &= parses(&parser, 1, bare) == PMARGP_ERR_FILE_OPEN;
+    free_parser(&parser);
+
+    unsetenv("PMARGP_TEST_MAX_DEPTH");
+    unsetenv("PMARGP_TEST_COUNT");
+    unsetenv("PMARGP_TEST_LETTER");
+    unsetenv("PMARGP_TEST_QUIET");
+    remove(config);
+    return result;
+}
+
+bool test_abbreviations() {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    int output = 0, offset = 0, verbose = 0, count = 0;
+    parser.add_argument(&parser, "-o", "--output", PMARGP_INT, &output, NULL, false);
+    parser.add_argument(&parser, NULL, "--offset", PMARGP_INT, &offset, NULL, false);
+    parser.add_argument(&parser, NULL, "--verbose", PMARGP_INT, &verbose, NULL, false);
+    parser.add_argument(&parser, NULL, "--verbose-level", PMARGP_INT, &count, NULL, false);
+
+    // Off by default: an abbreviation is just an unknown key
+    char *argv[] = {"program", "--out", "1", "--offs", "2", "--verbose", "3", "--verbose-l", "4"};
+    bool result = parses(&parser, 9, argv) == PMARGP_ERR_INVALID_KEY && output == 0;
+    free_parser(&parser);
+
+    parser_start(&parser);
+    parser.flags |= PMARGP_FLAG_ABBREV;
+    output = offset = verbose = count = 0;
+    parser.add_argument(&parser, "-o", "--output", PMARGP_INT, &output, NULL, false);
+    parser.add_argument(&parser, NULL, "--offset", PMARGP_INT, &offset, NULL, false);
+    parser.add_argument(&parser, NULL, "--verbose", PMARGP_INT, &verbose, NULL, false);
+    parser.add_argument(&parser, NULL, "--verbose-level", PMARGP_INT, &count, NULL, false);
+
+    // Unique prefixes resolve, and an exact key wins over the keys it prefixes
+    result &= parses(&parser, 9, argv) == PMARGP_SUCCESS;
+    result &= output == 1 && offset == 2 && verbose == 3 && count == 4;
+
+    const pmargp_argument_t *candidates[4];
+    result &= pmargp_candidates(&parser, "--o", candidates, 4) == 2;
+    result &= strcmp(candidates[0]->key, "--offset") == 0 && strcmp(candidates[1]->key, "--output") == 0;
+    result &= pmargp_candidates(&parser, "--verbose", NULL, 0) == 2;
+    result &= pmargp_candidates(&parser, "--x", candidates, 4) == 0;
+
+    // Registering more keys rebuilds the sorted array before the next parse
+    int origin = 0;
+    parser.add_argument(&parser, NULL, "--origin", PMARGP_INT, &origin, NULL, false);
+    char *ambiguous[] = {"program", "--o", "5"};
+    char *origin_argv[] = {"program", "--or", "6"};
+    result &= parses(&parser, 3, ambiguous) == PMARGP_ERR_AMBIGUOUS;
+    result &= parses(&parser, 3, origin_argv) == PMARGP_SUCCESS && origin == 6;
+    result &= pmargp_candidates(&parser, "--o", NULL, 0) == 3;
+
+    // Frozen parsers resolve abbreviations in contexts too
+    pmargp_freeze(&parser);
+    pmargp_context_t ctx;
+    pmargp_context_init(&ctx, &parser);
+    char *context_argv[] = {"program", "--outp", "7", "--verbose-", "8"};
+    result &= pmargp_parse_context(&ctx, 5, context_argv) == PMARGP_SUCCESS;
+    result &= pmargp_context_get(&ctx, "--output")->i == 7 && pmargp_context_get(&ctx, "--verbose-level")->i == 8;
+    result &= pmargp_parse_context(&ctx, 3, ambiguous) == PMARGP_ERR_AMBIGUOUS;
+    result &= ctx.error_index == -1 && strcmp(ctx.error_token, "--o") == 0;
+    pmargp_context_free(&ctx);
+    free_parser(&parser);
+    return result;
+}
+
+bool test_lexer() {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    parser.flags |= PMARGP_FLAG_NO_EXIT;
+    char *name = NULL, *output = NULL;
+    int count = 0;
+    bool all = false, quiet = false, verbose = false;
+    parser.add_argument(&parser, "-n", "--name", PMARGP_STRING, &name, NULL, false);
+    parser.add_argument(&parser, "-o", "--output", PMARGP_STRING, &output, NULL, false);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, false);
+    parser.add_argument(&parser, "-a", "--all", PMARGP_BOOL, &all, NULL, false);
+    parser.add_argument(&parser, "-q", "--quiet", PMARGP_BOOL, &quiet, NULL, false);
+    parser.add_argument(&parser, "-v", "--verbose", PMARGP_BOOL, &verbose, NULL, false);
+
+    // "--key=value" keeps everything after the first '=', including more '='
+    char *argv[] = {"program", "--name=a=b", "-aq", "-ofile.txt", "--count", "-3", "--quiet=no", "--", "-v", "--help"};
+    bool result = parses(&parser, 10, argv) == PMARGP_SUCCESS;
+    result &= strcmp(name, "a=b") == 0 && strcmp(output, "file.txt") == 0 && count == -3;
+    result &= all && quiet && !verbose;
+    result &= argv[1][6] == '=';  // split by length, argv is not written
+    free_parser(&parser);
+
+    parser_start(&parser);
+    parser.flags |= PMARGP_FLAG_NO_EXIT;
+    name = NULL;
+    count = 0;
+    all = quiet = verbose = false;
+    parser.add_argument(&parser, "-n", "--name", PMARGP_STRING, &name, NULL, false);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, false);
+    parser.add_argument(&parser, "-a", "--all", PMARGP_BOOL, &all, NULL, false);
+    parser.add_argument(&parser, "-v", "--verbose", PMARGP_BOOL, &verbose, NULL, false);
+
+    // A cluster ending in an option with a value takes the next token, and
+    // a repeated option skips its value instead of reading it as a key
+    char *cluster[] = {"program", "-avn", "Barry", "--count=1", "--count", "-v"};
+    result &= parses(&parser, 6, cluster) == PMARGP_SUCCESS;
+    result &= all && verbose && strcmp(name, "Barry") == 0 && count == 1;
+
+    // Help is found in the same pass, even after a bad value, but not after "--"
+    char *help_after_error[] = {"program", "--count", "x", "--help"};
+    char *help_in_cluster[] = {"program", "-ah"};
+    char *operand[] = {"program", "--", "-h"};
+    result &= parses(&parser, 4, help_after_error) == PMARGP_HELP_REQUESTED;
+    result &= parses(&parser, 2, help_in_cluster) == PMARGP_HELP_REQUESTED;
+    result &= parses(&parser, 3, operand) == PMARGP_SUCCESS;
+
+    free_parser(&parser);
+
+    // The same lexer drives the string and streaming entry points
+    parser_start(&parser);
+    parser.add_argument(&parser, "-n", "--name", PMARGP_STRING, &name, NULL, false);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, false);
+    char command[] = "--name='Vanessa Bloome' -c7";
+    result &= pmargp_parse_string(&parser, command, strlen(command)) == PMARGP_SUCCESS;
+    result &= strcmp(name, "Vanessa Bloome") == 0 && count == 7;
+    free_parser(&parser);
+
+    parser_start(&parser);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, false);
+    pmargp_begin(&parser);
+    char token[] = "--count=12";
+    result &= pmargp_feed(&parser, token, strlen(token)) == PMARGP_SUCCESS;
+    token[8] = '9';  // the value was converted, not kept
+    result &= pmargp_finish(&parser) == PMARGP_SUCCESS && count == 12;
+    free_parser(&parser);
+    return result;
+}
+
+bool test_positionals() {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    char *mode = NULL;
+    int level = 0;
+    bool verbose = false;
+    pmargp_span_t rest;
+    parser.add_argument(&parser, "-v", "--verbose", PMARGP_BOOL, &verbose, NULL, false);
+    bool result = pmargp_add_positional(&parser, "mode", PMARGP_STRING, &mode, "What to do", PMARGP_FLAG_REQUIRED) == PMARGP_SUCCESS;
+    result &= pmargp_add_positional(&parser, "level", PMARGP_INT, &level, NULL, 0) == PMARGP_SUCCESS;
+    result &= pmargp_add_positional(&parser, "flag", PMARGP_BOOL, &verbose, NULL, 0) == PMARGP_ERR_UNKNOWN_TYPE;
+    result &= pmargp_set_remainder(&parser, &rest) == PMARGP_SUCCESS;
+
+    // Trailing operands are a view of argv itself
+    char *argv[] = {"program", "build", "-v", "-5", "a.txt", "b.txt", "-", "c.txt"};
+    result &= parses(&parser, 8, argv) == PMARGP_SUCCESS;
+    result &= strcmp(mode, "build") == 0 && level == -5 && verbose;
+    result &= rest.count == 4 && rest.capacity == 0 && rest.items == &argv[4];
+    free_parser(&parser);
+
+    parser_start(&parser);
+    mode = NULL;
+    verbose = false;
+    parser.add_argument(&parser, "-v", "--verbose", PMARGP_BOOL, &verbose, NULL, false);
+    pmargp_add_positional(&parser, "mode", PMARGP_STRING, &mode, NULL, PMARGP_FLAG_REQUIRED);
+    pmargp_set_remainder(&parser, &rest);
+
+    // Interleaved operands are gathered, never copied, and "--" ends the options
+    char *mixed[] = {"program", "run", "x", "-v", "y", "--", "--verbose", "-h"};
+    result &= parses(&parser, 8, mixed) == PMARGP_SUCCESS && verbose;
+    result &= rest.count == 4 && rest.capacity > 0;
+    result &= rest.items[0] == mixed[2] && rest.items[1] == mixed[4] && rest.items[2] == mixed[6] && rest.items[3] == mixed[7];
+
+    char *unknown[] = {"program", "run", "-x"};
+    char *missing[] = {"program", "-v"};
+    result &= parses(&parser, 3, unknown) == PMARGP_ERR_INVALID_KEY;
+    free_parser(&parser);
+
+    parser_start(&parser);
+    mode = NULL;
+    pmargp_add_positional(&parser, "mode", PMARGP_STRING, &mode, NULL, PMARGP_FLAG_REQUIRED);
+    pmargp_set_remainder(&parser, &rest);
+    parser.add_argument(&parser, "-v", "--verbose", PMARGP_BOOL, &verbose, NULL, false);
+    result &= parses(&parser, 2, missing) == PMARGP_ERR_ARG_MISSING;
+
+    // Operands from a string point into the string
+    char command[] = "test 'a b' c";
+    result &= pmargp_parse_string(&parser, command, strlen(command)) == PMARGP_SUCCESS;
+    result &= strcmp(mode, "test") == 0 && rest.count == 2 && strcmp(rest.items[0], "a b") == 0;
+    result &= rest.items[1] == command + 11;
+
+    char help[1024];
+    pmargp_format_help(&parser, help, sizeof(help));
+    result &= strstr(help, "usage: program [OPTIONS] mode [...] \n") != NULL;
+
+    // Contexts keep their own positional values and remainder
+    pmargp_freeze(&parser);
+    pmargp_context_t ctx;
+    pmargp_context_init(&ctx, &parser);
+    char *tail[] = {"program", "deploy", "-v", "one", "two"};
+    result &= pmargp_parse_context(&ctx, 5, tail) == PMARGP_SUCCESS;
+    result &= strcmp(pmargp_context_positional(&ctx, 0)->s, "deploy") == 0 && !pmargp_context_positional(&ctx, 1);
+    result &= ctx.remainder.count == 2 && ctx.remainder.items == &tail[3] && ctx.operands == 3;
+    result &= pmargp_parse_context(&ctx, 2, missing) == PMARGP_ERR_ARG_MISSING && ctx.remainder.count == 0;
+    pmargp_context_free(&ctx);
+    free_parser(&parser);
+    return result;
+}
+
+bool test_numeric_lists() {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    pmargp_list_t ids = {{NULL}, 0, '\0', 0};
+    pmargp_list_t weights = {{NULL}, 0, ';', 0};
+    pmargp_list_t scales = {{NULL}, 0, '\0', 0};
+    pmargp_list_t empty = {{NULL}, 0, '\0', 0};
+    parser.add_argument(&parser, "-i", "--ids", PMARGP_INT_LIST, &ids, NULL, false);
+    parser.add_argument(&parser, "-w", "--weights", PMARGP_FLOAT_LIST, &weights, NULL, false);
+    parser.add_argument(&parser, "-s", "--scales", PMARGP_DOUBLE_LIST, &scales, NULL, false);
+    parser.add_argument(&parser, "-e", "--empty", PMARGP_INT_LIST, &empty, NULL, false);
+
+    // Long enough for several 32-byte blocks plus a tail
+    char id_text[4096], weight_text[4096];
+    size_t used = 0, weight_used = 0;
+    for (int i = 0; i < 500; i++) {
+        used += (size_t)snprintf(id_text + used, sizeof(id_text) - used, i ? ",%d" : "%d", i * 37 - 5000);
+    }
+    for (int i = 0; i < 300; i++) {
+        weight_used += (size_t)snprintf(weight_text + weight_used, sizeof(weight_text) - weight_used,
+                                        i ? ";%d.%d" : "%d.%d", i, i % 10);
+    }
+    char scale_text[] = "1e-3,-2.5,3";
+    char *argv[] = {"program", "--ids", id_text, "--weights", weight_text, "-s", scale_text, "--empty", ""};
+    bool result = parses(&parser, 9, argv) == PMARGP_SUCCESS;
+    result &= ids.count == 500 && weights.count == 300 && scales.count == 3 && empty.count == 0;
+    for (int i = 0; result && i < 500; i++) result &= ids.data.i[i] == i * 37 - 5000;
+    for (int i = 0; result && i < 300; i++) {
+        char element[16];
+        snprintf(element, sizeof(element), "%d.%d", i, i % 10);
+        result &= weights.data.f[i] == strtof(element, NULL);
+    }
+    result &= scales.data.d[0] == 1e-3 && scales.data.d[1] == -2.5 && scales.data.d[2] == 3.0;
+    free_parser(&parser);
+
+    // The failing element is reported, whether it falls in a block or in the tail
+    parser_start(&parser);
+    parser.add_argument(&parser, "-i", "--ids", PMARGP_INT_LIST, &ids, NULL, false);
+    char in_block[] = "1,2,3,4,5,6,7,8,9,10,11,x,13,14,15,16,17,18,19,20";
+    char in_tail[] = "1,2,3,";
+    char overflow[] = "1,99999999999";
+    char *bad_block[] = {"program", "--ids", in_block};
+    char *bad_tail[] = {"program", "--ids", in_tail};
+    char *bad_overflow[] = {"program", "--ids", overflow};
+    result &= parses(&parser, 3, bad_block) == PMARGP_ERR_INVALID_VALUE && ids.error_element == 11;
+    free_parser(&parser);
+    parser_start(&parser);
+    parser.add_argument(&parser, "-i", "--ids", PMARGP_INT_LIST, &ids, NULL, false);
+    result &= parses(&parser, 3, bad_tail) == PMARGP_ERR_INVALID_VALUE && ids.error_element == 3;
+    free_parser(&parser);
+
+    // Contexts convert into their own arena, with the registered delimiter
+    parser_start(&parser);
+    parser.add_argument(&parser, "-w", "--weights", PMARGP_FLOAT_LIST, &weights, NULL, false);
+    parser.add_argument(&parser, "-i", "--ids", PMARGP_INT_LIST, &ids, NULL, false);
+    pmargp_freeze(&parser);
+    pmargp_context_t ctx;
+    pmargp_context_init(&ctx, &parser);
+    char context_weights[] = "0.5;0.25";
+    char *context_argv[] = {"program", "-w", context_weights};
+    result &= pmargp_parse_context(&ctx, 3, context_argv) == PMARGP_SUCCESS;
+    const pmargp_value_t *list = pmargp_context_get(&ctx, "-w");
+    result &= list->list.count == 2 && list->list.data.f[0] == 0.5f && list->list.data.f[1] == 0.25f;
+    result &= pmargp_parse_context(&ctx, 3, bad_overflow) == PMARGP_ERR_INVALID_VALUE;
+    result &= ctx.error_index == 1 && ctx.error_element == 1 && pmargp_context_get(&ctx, "--ids") == NULL;
+    pmargp_context_free(&ctx);
+    free_parser(&parser);
+    return result;
+}
+
+bool test_stats() {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    int count = 0;
+    bool verbose = false;
+    char *name = NULL;
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, false);
+    parser.add_argument(&parser, "-v", "--verbose", PMARGP_BOOL, &verbose, NULL, false);
+    parser.add_argument(&parser, "-n", "--name", PMARGP_STRING, &name, NULL, false);
+
+    char *argv[] = {"program", "--count", "3", "-v", "--name", "x", "-c", "4"};
+    bool result = parses(&parser, 8, argv) == PMARGP_SUCCESS;
+    pmargp_stats_t stats;
+#ifdef PMARGP_STATS
+    result &= pmargp_stats(&parser, &stats) == PMARGP_SUCCESS;
+    result &= stats.tokens == 7 && stats.lookups == 4 && stats.key_compares >= 2;
+    // the repeated -c is skipped, so it is looked up but never converted
+    result &= stats.conversions[PMARGP_INT] == 1 && stats.conversions[PMARGP_BOOL] == 1;
+    result &= stats.conversions[PMARGP_STRING] == 1 && stats.files_opened == 0;
+    result &= stats.arena_bytes > 0;
+
+    // Contexts count their own parses, across resets
+    pmargp_freeze(&parser);
+    pmargp_context_t ctx;
+    pmargp_context_init(&ctx, &parser);
+    char *short_argv[] = {"program", "-c", "1"};
+    result &= pmargp_parse_context(&ctx, 3, short_argv) == PMARGP_SUCCESS;
+    result &= pmargp_parse_context(&ctx, 3, short_argv) == PMARGP_SUCCESS;
+    result &= pmargp_context_stats(&ctx, &stats) == PMARGP_SUCCESS;
+    result &= stats.tokens == 4 && stats.lookups == 2 && stats.conversions[PMARGP_INT] == 2;
+    result &= stats.registration_ns == 0;
+    pmargp_context_free(&ctx);
+#else
+    // Without the instrumentation the counters read as zero
+    memset(&stats, 0xff, sizeof(stats));
+    result &= pmargp_stats(&parser, &stats) == PMARGP_ERR_NO_STATS;
+    result &= stats.tokens == 0 && stats.arena_bytes == 0;
+#endif
+    result &= pmargp_stats(NULL, &stats) == PMARGP_ERR_NULL;
+    free_parser(&parser);
+    return result;
+}
+
+typedef struct {
+    int builds;
+    int jobs;
+    char *target;
+} build_options_t;
+
+static int build_command(struct pmargp_parser_t *parser, void *data) {
+    build_options_t *options = data;
+    options->builds++;
+    parser->add_argument(parser, "-j", "--jobs", PMARGP_INT, &options->jobs, "Parallel jobs", false);
+    return pmargp_add_positional(parser, "target", PMARGP_STRING, &options->target, NULL, PMARGP_FLAG_REQUIRED);
+}
+
+static int failing_command(struct pmargp_parser_t *parser, void *data) {
+    (void)parser;
+    (void)data;
+    return PMARGP_ERR_MEMORY_ALLOCATION;
+}
+
+bool test_subcommands() {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    parser.name = "tool";
+    parser.flags |= PMARGP_FLAG_NO_EXIT;
+    bool verbose = false, quiet = false;
+    char *config = NULL;
+    build_options_t build = {0, 0, NULL};
+    build_options_t other = {0, 0, NULL};
+    parser.add_argument(&parser, "-v", "--verbose", PMARGP_BOOL, &verbose, NULL, false);
+    parser.add_argument(&parser, "-c", "--config", PMARGP_STRING, &config, NULL, false);
+    parser.add_argument(&parser, "-q", "--quiet", PMARGP_BOOL, &quiet, NULL, false);
+    bool result = pmargp_add_command(&parser, "build", "Compile a target", build_command, &build) == PMARGP_SUCCESS;
+    result &= pmargp_add_command(&parser, "build", NULL, build_command, &build) == PMARGP_ERR_EXISTING_ARGUMENT;
+    result &= pmargp_add_command(&parser, "broken", NULL, failing_command, NULL) == PMARGP_SUCCESS;
+    for (int i = 0; i < 150; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "cmd%d", i);
+        result &= pmargp_add_command(&parser, name, NULL, build_command, &other) == PMARGP_SUCCESS;
+    }
+    result &= parser.command_count == 152;
+
+    // Only the selected command is built, parent options work on both sides
+    char *argv[] = {"tool", "-v", "build", "-j", "4", "--config", "x.ini", "all"};
+    result &= parses(&parser, 8, argv) == PMARGP_SUCCESS;
+    result &= verbose && build.jobs == 4 && strcmp(config, "x.ini") == 0 && strcmp(build.target, "all") == 0;
+    result &= build.builds == 1 && other.builds == 0 && parser.selected && parser.selected->parent == &parser;
+
+    // A cluster may mix the command's flags and its parent's
+    char *cluster[] = {"tool", "cmd149", "-qj8", "lib"};
+    result &= parses(&parser, 4, cluster) == PMARGP_SUCCESS;
+    result &= quiet && other.jobs == 8 && strcmp(other.target, "lib") == 0 && other.builds == 1;
+
+    char *unknown[] = {"tool", "deploy"};
+    char *bad_option[] = {"tool", "build", "--force", "all"};
+    char *missing[] = {"tool", "build", "-j", "2"};
+    char *broken[] = {"tool", "broken"};
+    char *after_terminator[] = {"tool", "--", "build"};
+    result &= parses(&parser, 2, unknown) == PMARGP_ERR_UNKNOWN_COMMAND;
+    result &= parses(&parser, 4, bad_option) == PMARGP_ERR_INVALID_KEY;
+    result &= parses(&parser, 4, missing) == PMARGP_ERR_ARG_MISSING;
+    result &= parses(&parser, 2, broken) == PMARGP_ERR_MEMORY_ALLOCATION;
+    result &= parses(&parser, 3, after_terminator) == PMARGP_SUCCESS && !parser.selected;
+
+    char line[] = "build -j 2 docs";
+    result &= pmargp_parse_string(&parser, line, strlen(line)) == PMARGP_SUCCESS;
+    result &= build.jobs == 2 && strcmp(build.target, "docs") == 0;
+
+    // Help lists the commands without building them, and is the command's after it
+    int builds = build.builds + other.builds;
+    char help[8192];
+    pmargp_format_help(&parser, help, sizeof(help));
+    result &= strstr(help, "usage: tool [OPTIONS] <command> \n") != NULL;
+    result &= strstr(help, "\nCommands:\n  build   Compile a target\n") != NULL;
+    result &= strstr(help, "  cmd149  No description\n") != NULL;
+    result &= build.builds + other.builds == builds;
+    char *help_argv[] = {"tool", "build", "--help"};
+    result &= parses(&parser, 3, help_argv) == PMARGP_HELP_REQUESTED && parser.selected;
+    pmargp_format_help(parser.selected, help, sizeof(help));
+    result &= strstr(help, "usage: tool build [OPTIONS] target \n") != NULL && strstr(help, "--jobs") != NULL;
+
+    // Contexts share a frozen parser and cannot build one
+    pmargp_freeze(&parser);
+    pmargp_context_t ctx;
+    pmargp_context_init(&ctx, &parser);
+    result &= pmargp_parse_context(&ctx, 8, argv) == PMARGP_ERR_FROZEN;
+    pmargp_context_free(&ctx);
+    free_parser(&parser);
+    return result;
+}
+
+bool test_choices() {
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    int mode = 1, level = 0, codec = -1, count = 0;
+    const pmargp_choice_t modes[] = {{"fast", 1}, {"safe", 2}, {"debug", 3}};
+    parser.add_argument(&parser, "-m", "--mode", PMARGP_CHOICE, &mode, "Run mode", false);
+    parser.add_argument(&parser, "-c", "--count", PMARGP_INT, &count, NULL, false);
+    pmargp_add_positional(&parser, "level", PMARGP_CHOICE, &level, NULL, 0);
+    bool result = pmargp_set_choices(&parser, "--mode", modes, 3) == PMARGP_SUCCESS;
+    result &= pmargp_set_choices(&parser, "level", modes, 2) == PMARGP_SUCCESS;
+    result &= pmargp_set_choices(&parser, "--count", modes, 3) == PMARGP_ERR_UNKNOWN_TYPE;
+    result &= pmargp_set_choices(&parser, "--missing", modes, 3) == PMARGP_ERR_INVALID_KEY;
+    const pmargp_choice_t twice[] = {{"on", 1}, {"off", 0}, {"on", 2}};
+    result &= pmargp_set_choices(&parser, "-m", twice, 3) == PMARGP_ERR_EXISTING_ARGUMENT;
+
+    char help[2048];
+    pmargp_format_help(&parser, help, sizeof(help));
+    result &= strstr(help, "(Type: choice) [Default: fast] [Choices: fast|safe|debug]\n") != NULL;
+
+    char *argv[] = {"program", "-m", "debug", "safe"};
+    result &= parses(&parser, 4, argv) == PMARGP_SUCCESS && mode == 3 && level == 2;
+    free_parser(&parser);
+
+    // Prefixes and extensions of a name are not that name
+    const char *invalid[] = {"turbo", "saf", "safer", "", "FAST"};
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        parser_start(&parser);
+        parser.add_argument(&parser, "-m", "--mode", PMARGP_CHOICE, &mode, NULL, false);
+        pmargp_set_choices(&parser, "--mode", modes, 3);
+        char *bad[] = {"program", "--mode", (char *)invalid[i]};
+        result &= parses(&parser, 3, bad) == PMARGP_ERR_INVALID_VALUE;
+        free_parser(&parser);
+    }
+
+    // 60 names are hashed, 100 are sorted; every name resolves either way
+    static char names[100][12];
+    pmargp_choice_t codecs[100];
+    for (int i = 0; i < 100; i++) {
+        snprintf(names[i], sizeof(names[i]), "codec%d", i);
+        codecs[i].name = names[i];
+        codecs[i].value = i * 10;
+    }
+    size_t sizes[] = {60, 100};
+    for (size_t s = 0; s < 2; s++) {
+        parser_start(&parser);
+        parser.add_argument(&parser, NULL, "--codec", PMARGP_CHOICE, &codec, NULL, false);
+        result &= pmargp_set_choices(&parser, "--codec", codecs, sizes[s]) == PMARGP_SUCCESS;
+        pmargp_freeze(&parser);
+        pmargp_context_t ctx;
+        pmargp_context_init(&ctx, &parser);
+        for (size_t i = 0; i < sizes[s]; i++) {
+            char *codec_argv[] = {"program", "--codec", names[i]};
+            result &= pmargp_parse_context(&ctx, 3, codec_argv) == PMARGP_SUCCESS;
+            result &= pmargp_context_get(&ctx, "--codec")->i == (int)i * 10;
+        }
+        char *unknown[] = {"program", "--codec", "codec100"};
+        char *prefix[] = {"program", "--codec", "codec"};
+        result &= pmargp_parse_context(&ctx, 3, unknown) == PMARGP_ERR_INVALID_VALUE;
+        result &= pmargp_parse_context(&ctx, 3, prefix) == PMARGP_ERR_INVALID_VALUE;
+        pmargp_context_free(&ctx);
+        free_parser(&parser);
+    }
+    return result;
+}
+
+bool test_batched_files() {
+    enum { FILES = 16 };
+    static char keys[FILES][12], paths[FILES][40];
+    for (int i = 0; i < FILES; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "--in%d", i);
+        snprintf(paths[i], sizeof(paths[i]), "/tmp/pmargp_batch_%d.txt", i);
+        FILE *seed = fopen(paths[i], "w");
+        if (!seed) return false;
+        fprintf(seed, "%d", i);
+        fclose(seed);
+    }
+    const char *output_path = "/tmp/pmargp_batch_out.txt";
+    remove(output_path);
+
+    struct pmargp_parser_t parser;
+    parser_start(&parser);
+    parser.flags |= PMARGP_FLAG_BATCH;
+    FILE *inputs[FILES] = {NULL}, *output = NULL;
+    pmargp_mmap_t view = {NULL, 0, PMARGP_MADV_SEQUENTIAL};
+    for (int i = 0; i < FILES; i++) parser.add_argument(&parser, NULL, keys[i], PMARGP_R_FILE, &inputs[i], NULL, false);
+    parser.add_argument(&parser, "-o", "--output", PMARGP_W_FILE, &output, NULL, false);
+    parser.add_argument(&parser, "-v", "--view", PMARGP_MMAP_FILE, &view, NULL, false);
+    parser.add_argument(&parser, "-r", "--required", PMARGP_INT, &(int){0}, NULL, true);
+    bool result = pmargp_set_open_workers(&parser, 0) == PMARGP_ERR_INVALID_VALUE;
+    result &= pmargp_set_open_workers(&parser, 4) == PMARGP_SUCCESS;
+
+    char *argv[2 * FILES + 7];
+    argv[0] = "program";
+    for (int i = 0; i < FILES; i++) {
+        argv[1 + 2 * i] = keys[i];
+        argv[2 + 2 * i] = paths[i];
+    }
+    argv[2 * FILES + 1] = "-o";
+    argv[2 * FILES + 2] = (char *)output_path;
+    argv[2 * FILES + 3] = "-v";
+    argv[2 * FILES + 4] = paths[FILES - 1];
+    argv[2 * FILES + 5] = "-r";
+    argv[2 * FILES + 6] = "1";
+
+    // A parse that fails its required check opens nothing, not even the output
+    result &= parses(&parser, 2 * FILES + 5, argv) == PMARGP_ERR_ARG_MISSING;
+    FILE *probe = fopen(output_path, "r");
+    result &= output == NULL && view.data == NULL && probe == NULL;
+    if (probe) fclose(probe);
+    free_parser(&parser);
+
+    // Every file lands in its own argument, whichever thread opened it
+    parser_start(&parser);
+    parser.flags |= PMARGP_FLAG_BATCH;
+    for (int i = 0; i < FILES; i++) parser.add_argument(&parser, NULL, keys[i], PMARGP_R_FILE, &inputs[i], NULL, false);
+    parser.add_argument(&parser, "-o", "--output", PMARGP_W_FILE, &output, NULL, false);
+    parser.add_argument(&parser, "-v", "--view", PMARGP_MMAP_FILE, &view, NULL, false);
+    result &= parses(&parser, 2 * FILES + 5, argv) == PMARGP_SUCCESS;
+    for (int i = 0; i < FILES; i++) {
+        int number = -1;
+        result &= inputs[i] && fscanf(inputs[i], "%d", &number) == 1 && number == i;
+        if (inputs[i]) fclose(inputs[i]);
+        inputs[i] = NULL;
+    }
+    result &= output != NULL && view.size == 2 && memcmp(view.data, "15", 2) == 0;
+    if (output) fclose(output);
+    output = NULL;
+    free_parser(&parser);
+    result &= view.data == NULL;
+
+    // Failures are reported together and nothing of the batch stays open
+    parser_start(&parser);
+    parser.flags |= PMARGP_FLAG_BATCH;
+    pmargp_set_open_workers(&parser, 1);
+    for (int i = 0; i < FILES; i++) parser.add_argument(&parser, NULL, keys[i], PMARGP_R_FILE, &inputs[i], NULL, false);
+    parser.add_argument(&parser, "-v", "--view", PMARGP_MMAP_FILE, &view, NULL, false);
+    argv[4] = "/nonexistent/dir/one";
+    argv[2 * FILES] = "/nonexistent/dir/two";
+    char *failing[] = {argv[0], argv[1], argv[2], argv[3], argv[4], argv[2 * FILES - 1], argv[2 * FILES],
+                       "-v", paths[0]};
+    result &= parses(&parser, 9, failing) == PMARGP_ERR_FILE_OPEN;
+    for (int i = 0; i < FILES; i++) result &= inputs[i] == NULL;
+    result &= view.data == NULL;
+    free_parser(&parser);
+
+    for (int i = 0; i < FILES; i++) remove(paths[i]);
+    remove(output_path);
+    return result;
+}
 
 int main(int argc, char *argv[]) {
     
@@ -331,22 +1699,42 @@ int main(int argc, char *argv[]) {
         test_basic_parsing,
         test_default_values,
         test_multiple_strings,
+        test_many_arguments,
+        test_custom_allocator,
+        test_bulk_registration,
+        test_borrowed_strings,
+        test_lazy_files,
+        test_mmap_file,
     };
     const char *basic_test_names[] = {
         "test_basic_parsing",
         "test_default_values",
         "test_multiple_strings",
+        "test_many_arguments",
+        "test_custom_allocator",
+        "test_bulk_registration",
+        "test_borrowed_strings",
+        "test_lazy_files",
+        "test_mmap_file",
     };
 
     TestFunction error_handling_tests[] = {
         test_missing_required_arguments,
         test_invalid_argument,
         test_unrecognized_short_key,
+        test_key_validation,
+        test_integer_types,
+        test_float_conformance,
+        test_numeric_lists,
     };
     const char *error_handling_test_names[] = {
         "test_missing_required_arguments",
         "test_invalid_argument",
         "test_unrecognized_short_key",
+        "test_key_validation",
+        "test_integer_types",
+        "test_float_conformance",
+        "test_numeric_lists",
     };
 
     TestFunction boolean_tests[] = {
@@ -364,13 +1752,39 @@ int main(int argc, char *argv[]) {
         test_whitespace_in_strings,
         test_negative_numbers,
         test_argument_order,
-        test_quoted_strings
+        test_quoted_strings,
+        test_response_files,
+        test_streaming_parse,
+        test_parse_string,
+        test_frozen_contexts,
+        test_format_help,
+        test_layered_sources,
+        test_abbreviations,
+        test_lexer,
+        test_positionals,
+        test_stats,
+        test_subcommands,
+        test_choices,
+        test_batched_files
     };
     const char *advanced_test_names[] = {
         "test_whitespace_in_strings",
         "test_negative_numbers",
         "test_argument_order",
-        "test_quoted_strings"
+        "test_quoted_strings",
+        "test_response_files",
+        "test_streaming_parse",
+        "test_parse_string",
+        "test_frozen_contexts",
+        "test_format_help",
+        "test_layered_sources",
+        "test_abbreviations",
+        "test_lexer",
+        "test_positionals",
+        "test_stats",
+        "test_subcommands",
+        "test_choices",
+        "test_batched_files"
     };
 
     // Run tests based on input
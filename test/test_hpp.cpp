@@ -0,0 +1,158 @@
+#include "pmargp.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+typedef bool (*TestFunction)();
+
+bool run_test(const char *test_name, TestFunction fn) {
+    bool result = fn();
+    printf("\r%s %s... %s\n", result ? "✅" : "❌", result ? "PASSED" : "FAILED",  test_name);
+    return result;
+}
+
+bool run_test_group(TestFunction *tests, const char **test_names, size_t count) {
+    printf("\n============== Running Test Group ==============\n");
+    bool result = true;
+    for (size_t i = 0; i < count; ++i) {
+        bool test_result = run_test(test_names[i], tests[i]);
+        if (test_result == false){
+            result = test_result;
+        }
+    }
+    printf("================================================\n");
+    return result;
+}
+
+struct options {
+    int count = 1;
+    std::string_view name;
+    double value = 0.5;
+    bool quiet = false;
+    long long big = 0;
+    char character = 'x';
+    pmargp::w_file output;
+};
+
+constexpr auto cli = pmargp::make_spec(
+    pmargp::opt<&options::count>("-c", "--count", "Number of greetings"),
+    pmargp::opt<&options::name>("-n", "--name", "Your name", PMARGP_FLAG_REQUIRED),
+    pmargp::opt<&options::value>("-v", "--value", "A floating-point value"),
+    pmargp::opt<&options::quiet>(nullptr, "--quiet", "Run in quiet mode"),
+    pmargp::opt<&options::big>(nullptr, "--big", "A 64-bit integer"),
+    pmargp::opt<&options::character>("-r", "--character", "Random character"),
+    pmargp::opt<&options::output>("-o", "--output", "Output file"));
+
+// The lookup table is built while the spec is constant-evaluated
+static_assert(cli.find("--count") == 0 && cli.find("-c") == 0);
+static_assert(cli.find("--output") == 6 && cli.find("-o") == 6);
+static_assert(cli.find("--missing") == -1 && cli.find("-z") == -1 && cli.find("") == -1);
+static_assert(!std::is_copy_constructible_v<pmargp::w_file> && std::is_nothrow_move_constructible_v<pmargp::w_file>);
+
+bool test_basic_parsing() {
+    const char *argv[] = {"program", "--name", "bee", "-c", "42", "--value", "3.25", "--quiet", "--big", "9000000000", "-r", "yes"};
+    auto r = pmargp::parse(cli, sizeof(argv) / sizeof(argv[0]), argv);
+    return r.error == PMARGP_SUCCESS && !r.help && r.values.name == "bee" && r.values.count == 42 &&
+           r.values.value == 3.25 && r.values.quiet && r.values.big == 9000000000LL && r.values.character == 'y' &&
+           r.has<&options::count>() && !r.has<&options::output>();
+}
+
+bool test_default_values() {
+    const char *argv[] = {"program", "-n", "bee"};
+    auto r = pmargp::parse(cli, 3, argv);
+    return r.error == PMARGP_SUCCESS && r.values.count == 1 && r.values.value == 0.5 && !r.values.quiet &&
+           r.values.character == 'x' && !r.values.output;
+}
+
+bool test_first_occurrence_wins() {
+    const char *argv[] = {"program", "-n", "bee", "-c", "42", "--count", "100"};
+    auto r = pmargp::parse(cli, 7, argv);
+    return r.error == PMARGP_SUCCESS && r.values.count == 42;
+}
+
+bool test_missing_required_arguments() {
+    const char *argv[] = {"program", "--count", "3"};
+    auto r = pmargp::parse(cli, 3, argv);
+    return r.error == PMARGP_ERR_ARG_MISSING && r.error_key == "--name";
+}
+
+bool test_invalid_values() {
+    const char *overflow[] = {"program", "-n", "bee", "--count", "99999999999"};
+    const char *garbage[] = {"program", "-n", "bee", "--value", "1.5x"};
+    auto a = pmargp::parse(cli, 5, overflow);
+    auto b = pmargp::parse(cli, 5, garbage);
+    return a.error == PMARGP_ERR_INVALID_VALUE && a.error_index == 4 && a.error_key == "--count" &&
+           b.error == PMARGP_ERR_INVALID_VALUE && b.error_key == "--value";
+}
+
+bool test_negative_numbers() {
+    const char *argv[] = {"program", "-n", "bee", "--count", "-42", "--value", "-3.14"};
+    auto r = pmargp::parse(cli, 7, argv);
+    return r.error == PMARGP_SUCCESS && r.values.count == -42 && std::fabs(r.values.value + 3.14) < 1e-12;
+}
+
+bool test_help_does_not_exit() {
+    const char *argv[] = {"program", "--count", "3", "--help"};
+    auto r = pmargp::parse(cli, 4, argv);
+    return r.help && r.error == PMARGP_SUCCESS;
+}
+
+bool test_file_ownership() {
+    const char *argv[] = {"program", "-n", "bee", "-o", "/dev/null"};
+    auto r = pmargp::parse(cli, 5, argv);
+    if (r.error != PMARGP_SUCCESS || !r.values.output) return false;
+
+    pmargp::w_file moved = std::move(r.values.output);
+    bool ok = moved && !r.values.output && std::fputs("discarded", moved.get()) >= 0;
+
+    const char *missing[] = {"program", "-n", "bee", "-o", "/nonexistent/dir/file"};
+    auto failed = pmargp::parse(cli, 5, missing);
+    return ok && failed.error == PMARGP_ERR_FILE_OPEN && !failed.values.output;
+}
+
+bool test_lexer_forms() {
+    const char *argv[] = {"program", "--name=bee", "-c7", "-r", "z", "--value=-1.5", "-", "operand", "--", "--big", "-c"};
+    auto r = pmargp::parse(cli, sizeof(argv) / sizeof(argv[0]), argv);
+    bool forms = r.error == PMARGP_SUCCESS && r.values.name == "bee" && r.values.count == 7 &&
+                 r.values.character == 'z' && r.values.value == -1.5 && r.values.big == 0;
+
+    const char *cluster[] = {"program", "-n", "bee", "-qc", "4"};
+    auto unknown_short = pmargp::parse(cli, 5, cluster);
+    const char *misspelt[] = {"program", "-n", "bee", "--cuont=4"};
+    auto unknown_long = pmargp::parse(cli, 4, misspelt);
+    const char *late_help[] = {"program", "--bogus", "--count", "3", "-h"};
+    auto help = pmargp::parse(cli, 5, late_help);
+    return forms && unknown_short.error == PMARGP_ERR_INVALID_KEY && unknown_short.error_index == 3 &&
+           unknown_long.error == PMARGP_ERR_INVALID_KEY && unknown_long.error_key == "--cuont" &&
+           help.help && help.error == PMARGP_SUCCESS;
+}
+
+int main() {
+    TestFunction tests[] = {
+        test_basic_parsing,
+        test_default_values,
+        test_first_occurrence_wins,
+        test_missing_required_arguments,
+        test_invalid_values,
+        test_negative_numbers,
+        test_help_does_not_exit,
+        test_file_ownership,
+        test_lexer_forms,
+    };
+    const char *test_names[] = {
+        "test_basic_parsing",
+        "test_default_values",
+        "test_first_occurrence_wins",
+        "test_missing_required_arguments",
+        "test_invalid_values",
+        "test_negative_numbers",
+        "test_help_does_not_exit",
+        "test_file_ownership",
+        "test_lexer_forms",
+    };
+
+    bool result = run_test_group(tests, test_names, sizeof(tests) / sizeof(tests[0]));
+    printf("== END ==\n");
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}